@@ -0,0 +1,131 @@
+// Métricas agronômicas derivadas (ponto de orvalho, VPD e DLI)
+//
+// Calculadas a cada amostra, a partir de temperatura, umidade e luminosidade:
+//   - Pressão de saturação es(T): Magnus-Tetens (FAO-56)
+//       es(T) = 0,6108 * exp(17,27 T / (T + 237,3))  [kPa]
+//     tabelada de -40 a 60 °C a cada 0,5 °C e interpolada linearmente
+//     (exp só em begin()).
+//   - Pressão de vapor atual: ea = es(T) * UR / 100
+//   - VPD = es(T) - ea  [kPa]
+//   - Ponto de orvalho: Magnus invertida, Td = 237,3 g / (17,27 - g) com
+//     g = ln(ea / 0,6108). O ln vem do expoente do float mais uma série de
+//     atanh na mantissa (fastLog), sem logf.
+//   - DLI: integral da PPFD no dia (regra do trapézio)  [mol/m²/dia]
+//     PPFD estimada do lux com o fator da luz solar (0,0185 µmol/m²/s por lux).
+//     O acumulador é inteiro (nmol/m²), sem perda de precisão ao longo do dia.
+//
+// Erros máximos frente às fórmulas de referência (host/agro_bench.cpp):
+//   es relativo < 0,05 %, VPD < 0,002 kPa, ponto de orvalho < 0,01 °C.
+// Pontos de orvalho abaixo de -40 °C são limitados a -40 °C.
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+namespace agro {
+
+const float TABLE_MIN_C = -40.0f;
+const float TABLE_MAX_C = 60.0f;
+const float TABLE_STEP_C = 0.5f;
+const int TABLE_SIZE = 201;  // (MAX - MIN) / STEP + 1
+
+const float LN_ES_ZERO = -0.49298965f;   // ln(0,6108)
+const float LUX_TO_PPFD = 0.0185f;        // µmol/m²/s por lux (luz solar)
+const uint32_t DLI_MAX_GAP_MS = 600000;   // Intervalos maiores não são integrados
+
+// ln(x) para x normal e positivo: expoente do float + série de atanh na
+// mantissa reduzida a [√½, √2) (|erro| < 1e-7)
+inline float fastLog(float x) {
+  uint32_t bits;
+  memcpy(&bits, &x, sizeof(bits));
+  int e = (int)(bits >> 23) - 127;
+  bits = (bits & 0x007FFFFF) | 0x3F800000;  // Mantissa em [1, 2)
+  float m;
+  memcpy(&m, &bits, sizeof(m));
+  bool high = m > 1.41421356f;
+  m = high ? m * 0.5f : m;
+  e = high ? e + 1 : e;
+  // ln(m) = 2 atanh(t), t = (m - 1) / (m + 1), |t| < 0,172
+  float t = (m - 1) / (m + 1);
+  float t2 = t * t;
+  float series = t * (2.0f + t2 * (2.0f / 3 + t2 * (2.0f / 5 + t2 * (2.0f / 7))));
+  return series + e * 0.69314718f;
+}
+
+class Engine {
+public:
+  // Monta a tabela de pressão de saturação
+  void begin() {
+    for (int i = 0; i < TABLE_SIZE; i++) {
+      double t = TABLE_MIN_C + i * (double)TABLE_STEP_C;
+      es[i] = (float)(0.6108 * exp(17.27 * t / (t + 237.3)));
+    }
+  }
+
+  // Pressão de saturação (kPa), limitada ao intervalo da tabela
+  float saturationPressure(float t) const {
+    float x = (t - TABLE_MIN_C) * (1.0f / TABLE_STEP_C);
+    if (x <= 0) return es[0];
+    if (x >= TABLE_SIZE - 1) return es[TABLE_SIZE - 1];
+    int i = (int)x;
+    float f = x - i;
+    return es[i] + (es[i + 1] - es[i]) * f;
+  }
+
+  // Temperatura em que a pressão de saturação vale ea (°C)
+  float dewPointFromVapor(float ea) const {
+    if (ea <= es[0]) return TABLE_MIN_C;
+    float g = fastLog(ea) - LN_ES_ZERO;
+    return 237.3f * g / (17.27f - g);
+  }
+
+  // Atualiza o clima (temperatura em °C, umidade relativa em %)
+  void updateClimate(float t, float rh) {
+    if (rh < 0) rh = 0;
+    if (rh > 100) rh = 100;
+    float sat = saturationPressure(t);
+    float ea = sat * rh * 0.01f;
+    vpd = sat - ea;
+    dewPoint = dewPointFromVapor(ea);
+    if (dewPoint > t) dewPoint = t;  // Erro de interpolação com UR = 100%
+    climateValid = true;
+  }
+
+  // Integra a luz até nowMs. day identifica o dia local (muda à meia-noite).
+  void updateLight(uint32_t nowMs, uint32_t day, float lux) {
+    float ppfd = lux * LUX_TO_PPFD;
+    if (day != currentDay) {
+      previousDli = hasLight ? dli : 0.0f;
+      accumulatedNmol = 0;
+      currentDay = day;
+    } else if (hasLight) {
+      uint32_t dt = nowMs - lastLightMs;
+      if (dt <= DLI_MAX_GAP_MS) {
+        // µmol/m²/s * ms = nmol/m²
+        accumulatedNmol += (uint64_t)((lastPpfd + ppfd) * 0.5f * dt + 0.5f);
+      }
+    }
+    lastPpfd = ppfd;
+    lastLightMs = nowMs;
+    hasLight = true;
+    dli = (float)(accumulatedNmol / 1000) * 1e-6f;  // nmol → µmol → mol
+  }
+
+  float dewPoint = 0.0;     // °C
+  float vpd = 0.0;          // kPa
+  float dli = 0.0;          // mol/m²/dia (acumulado do dia atual)
+  float previousDli = 0.0;  // DLI completo do dia anterior
+  bool climateValid = false;
+
+private:
+  float es[TABLE_SIZE];
+  uint64_t accumulatedNmol = 0;
+  uint32_t currentDay = 0;
+  uint32_t lastLightMs = 0;
+  float lastPpfd = 0.0;
+  bool hasLight = false;
+};
+
+}  // namespace agro
@@ -0,0 +1,18 @@
+// Regras de alerta local, compartilhadas por main.cpp e main_teste.cpp
+//
+// Avaliadas a cada leitura por alerts::Engine (alerts.h), sem depender da
+// nuvem. O código do evento deve existir no template do Blynk
+// (Blynk.logEvent).
+
+#pragma once
+
+#include "alerts.h"
+
+const alerts::Rule alertRules[] = {
+  // canal, condição, limite, histerese, duração (s), janela (s), evento Blynk
+  {tsdb::CH_SOIL,        alerts::BELOW,     20.0,  5.0,   30, 0,  "solo_seco"},
+  {tsdb::CH_TEMPERATURE, alerts::ABOVE,     35.0,  2.0,   30, 0,  "calor"},
+  {tsdb::CH_TEMPERATURE, alerts::RISE_RATE, 2.0,   1.0,   0,  60, "aquecimento_rapido"},
+  {tsdb::CH_LIGHT,       alerts::FALL_RATE, 600.0, 300.0, 0,  10, "perda_luz"},
+};
+const uint8_t ALERT_RULE_COUNT = sizeof(alertRules) / sizeof(alertRules[0]);
@@ -0,0 +1,222 @@
+// Motor de alertas local (avaliado a cada amostra)
+//
+// As regras são declaradas numa tabela (Rule) e compiladas em begin() para
+// uma forma compacta e uniforme (CompiledRule): toda condição vira
+// "métrica * sinal > gatilho", onde a métrica é o valor do canal ou sua taxa
+// de variação (unidades/minuto). Assim a avaliação não depende do tipo de regra.
+//
+// Cada regra suporta:
+//   - histerese: só limpa quando a métrica volta abaixo de (gatilho - histerese)
+//   - duração mínima: a condição precisa se manter por sustainSeconds
+//   - taxa de variação: medida numa janela de rateWindowSeconds
+//
+// Alertas disparados sem conexão com a nuvem ficam no Outbox (um pendente
+// por regra, com o último valor) e são enviados na reconexão.
+//
+// Os canais seguem a ordem de tsdb::Channel (channels.h). A cada amostra,
+// uma máscara indica os canais com leitura válida: regras de um canal
+// inválido (sensor com falha ou não inicializado) não são avaliadas, não
+// disparam nem normalizam, e recomeçam a janela de taxa quando ele volta.
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "channels.h"
+
+namespace alerts {
+
+enum Condition : uint8_t {
+  ABOVE,      // valor > limite
+  BELOW,      // valor < limite
+  RISE_RATE,  // subida > limite (unidades/min)
+  FALL_RATE   // queda > limite (unidades/min)
+};
+
+// Definição de uma regra
+struct Rule {
+  uint8_t channel;             // tsdb::Channel
+  Condition condition;
+  float threshold;
+  float hysteresis;
+  uint16_t sustainSeconds;     // 0 = dispara na primeira amostra
+  uint16_t rateWindowSeconds;  // Apenas para RISE_RATE/FALL_RATE
+  const char* eventCode;       // Código do evento (Blynk.logEvent)
+};
+
+// Forma compilada: métrica * sign comparada com trigger/release
+struct CompiledRule {
+  uint8_t channel;
+  bool isRate;
+  int8_t sign;
+  float trigger;
+  float release;
+  uint32_t sustainMs;
+  uint32_t windowMs;
+};
+
+// Estado de execução de cada regra
+struct RuleState {
+  uint32_t conditionSince;  // Início da condição (ms)
+  uint32_t rateRefTime;     // Referência da janela de taxa (ms)
+  float rateRef;
+  float metric;             // Última métrica calculada
+  bool pending;             // Condição verdadeira, aguardando duração
+  bool active;              // Alerta disparado
+  bool hasRef;
+};
+
+// Chamado quando um alerta dispara (active = true) ou é normalizado
+typedef void (*AlertCallback)(const Rule& rule, bool active, float value, void* ctx);
+
+class Engine {
+public:
+  // compiled e state devem ter count entradas
+  Engine(const Rule* rules, CompiledRule* compiled, RuleState* state, uint8_t count)
+    : rules(rules), compiled(compiled), state(state), count(count) {}
+
+  void begin() {
+    for (uint8_t i = 0; i < count; i++) {
+      const Rule& r = rules[i];
+      CompiledRule& c = compiled[i];
+      c.channel = r.channel;
+      c.isRate = r.condition == RISE_RATE || r.condition == FALL_RATE;
+      c.sign = (r.condition == BELOW || r.condition == FALL_RATE) ? -1 : 1;
+      // Taxas usam limite positivo (magnitude da subida ou queda)
+      c.trigger = c.isRate ? r.threshold : c.sign * r.threshold;
+      c.release = c.trigger - r.hysteresis;
+      c.sustainMs = r.sustainSeconds * 1000UL;
+      c.windowMs = r.rateWindowSeconds * 1000UL;
+      memset(&state[i], 0, sizeof(RuleState));
+    }
+  }
+
+  // Avalia todas as regras. validMask: bit n = canal n com leitura válida.
+  // Retorna o número de transições (disparo/normalização).
+  uint8_t evaluate(uint32_t nowMs, const float* values, uint8_t validMask,
+                   AlertCallback cb, void* ctx) {
+    uint8_t transitions = 0;
+    for (uint8_t i = 0; i < count; i++) {
+      const CompiledRule& c = compiled[i];
+      RuleState& s = state[i];
+      float value = values[c.channel];
+
+      if (!(validMask & (1 << c.channel))) {
+        // Valor antigo ou zerado: não conta duração nem serve de referência
+        s.pending = false;
+        s.hasRef = false;
+        continue;
+      }
+
+      if (c.isRate) {
+        // Taxa recalculada a cada janela completa (evita ruído entre amostras)
+        if (!s.hasRef) {
+          s.rateRef = value;
+          s.rateRefTime = nowMs;
+          s.hasRef = true;
+          continue;
+        }
+        uint32_t elapsed = nowMs - s.rateRefTime;
+        if (elapsed == 0 || elapsed < c.windowMs) continue;
+        s.metric = c.sign * (value - s.rateRef) * 60000.0f / elapsed;
+        s.rateRef = value;
+        s.rateRefTime = nowMs;
+      } else {
+        s.metric = c.sign * value;
+      }
+
+      if (!s.active) {
+        if (s.metric > c.trigger) {
+          if (!s.pending) {
+            s.pending = true;
+            s.conditionSince = nowMs;
+          }
+          if (nowMs - s.conditionSince >= c.sustainMs) {
+            s.active = true;
+            s.pending = false;
+            transitions++;
+            if (cb) cb(rules[i], true, value, ctx);
+          }
+        } else {
+          s.pending = false;
+        }
+      } else if (s.metric < c.release) {
+        s.active = false;
+        transitions++;
+        if (cb) cb(rules[i], false, value, ctx);
+      }
+    }
+    return transitions;
+  }
+
+  bool isActive(uint8_t i) const { return i < count && state[i].active; }
+  uint8_t ruleCount() const { return count; }
+
+private:
+  const Rule* rules;
+  CompiledRule* compiled;
+  RuleState* state;
+  uint8_t count;
+};
+
+// Alerta retido até a reconexão
+struct PendingAlert {
+  bool pending;
+  uint8_t occurrences;  // Disparos desde o último envio
+  uint32_t firstMs;     // Primeiro disparo retido (ms)
+  float value;          // Valor do último disparo
+};
+
+// Envio de um alerta retido: quantas vezes disparou e há quanto tempo (ms)
+typedef void (*SendCallback)(const Rule& rule, float value, uint8_t occurrences,
+                             uint32_t ageMs);
+
+class Outbox {
+public:
+  // slots deve ter count entradas, na ordem da tabela de regras
+  Outbox(const Rule* rules, PendingAlert* slots, uint8_t count)
+    : rules(rules), slots(slots), count(count) {
+    memset(slots, 0, count * sizeof(PendingAlert));
+  }
+
+  // Retém o alerta de rule (elemento da tabela de regras)
+  void hold(const Rule& rule, float value, uint32_t nowMs) {
+    ptrdiff_t i = &rule - rules;
+    if (i < 0 || i >= count) return;
+    PendingAlert& p = slots[i];
+    if (!p.pending) {
+      p.pending = true;
+      p.occurrences = 0;
+      p.firstMs = nowMs;
+    }
+    if (p.occurrences < 0xFF) p.occurrences++;
+    p.value = value;
+  }
+
+  // Envia os alertas retidos. Retorna quantos foram enviados.
+  uint8_t flush(uint32_t nowMs, SendCallback send) {
+    uint8_t sent = 0;
+    for (uint8_t i = 0; i < count; i++) {
+      PendingAlert& p = slots[i];
+      if (!p.pending) continue;
+      send(rules[i], p.value, p.occurrences, nowMs - p.firstMs);
+      p.pending = false;
+      sent++;
+    }
+    return sent;
+  }
+
+  uint8_t pendingCount() const {
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < count; i++) if (slots[i].pending) n++;
+    return n;
+  }
+
+private:
+  const Rule* rules;
+  PendingAlert* slots;
+  uint8_t count;
+};
+
+}  // namespace alerts
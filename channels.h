@@ -0,0 +1,19 @@
+// Canais de amostra do sistema, na ordem usada pelo histórico em flash
+// (timeseries.h) e pelas regras de alerta (alerts.h)
+
+#pragma once
+
+#include <stdint.h>
+
+namespace tsdb {
+
+const uint8_t CHANNEL_COUNT = 5;
+enum Channel {
+  CH_TEMPERATURE = 0,  // °C
+  CH_HUMIDITY = 1,     // %
+  CH_LIGHT = 2,        // lux
+  CH_SOIL = 3,         // %
+  CH_RSSI = 4          // dBm
+};
+
+}  // namespace tsdb
@@ -0,0 +1,158 @@
+// Estado de conectividade em cache (WiFi e Blynk)
+//
+// Em vez de consultar WiFi.status() e Blynk.connected() várias vezes por
+// ciclo do loop(), o estado é atualizado pelos eventos do sistema:
+//   - WiFi: WiFi.onEvent (GOT_IP / DISCONNECTED), registrado em attachWifiEvents()
+//   - Blynk: BLYNK_CONNECTED() / BLYNK_DISCONNECTED() no sketch
+// As leituras são O(1). Os contadores de desconexão/reconexão contam cada
+// transição, inclusive quedas rápidas que o polling não veria; o loop
+// consulta as transições novas com pollChanges().
+//
+// O RSSI é amostrado em agenda própria (rssiDue/markRssiSampled) e suavizado
+// por RssiFilter (média móvel exponencial), usado pelo datapath.
+//
+// Os eventos de WiFi rodam na task de eventos do ESP32: cada campo tem um
+// único escritor e é uma palavra alinhada, então volatile é suficiente.
+
+#pragma once
+
+#include <stdint.h>
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <WiFi.h>
+#endif
+
+namespace connectivity {
+
+const uint32_t RSSI_SAMPLE_INTERVAL_MS = 5000;
+const float RSSI_SMOOTHING = 0.25f;  // Peso da amostra nova
+
+// Suavização do RSSI (média móvel exponencial, semeada pela primeira amostra)
+class RssiFilter {
+public:
+  void update(int rssi) {
+    if (!seeded) {
+      smoothed = rssi;
+      seeded = true;
+    } else {
+      smoothed += RSSI_SMOOTHING * (rssi - smoothed);
+    }
+  }
+
+  int value() const {
+    return (int)(smoothed < 0 ? smoothed - 0.5f : smoothed + 0.5f);
+  }
+
+  bool valid() const { return seeded; }
+
+private:
+  float smoothed = 0;
+  bool seeded = false;
+};
+
+class State {
+public:
+  // ---- Eventos ----
+  void onWifiConnected() {
+    if (wifiUp) return;
+    wifiUp = true;
+    if (wifiEverConnected) wifiReconnectCount++;
+    wifiEverConnected = true;
+  }
+
+  void onWifiDisconnected() {
+    // O ESP32 repete DISCONNECTED a cada tentativa: conta só a transição
+    if (!wifiUp) return;
+    wifiUp = false;
+    wifiDisconnectCount++;
+  }
+
+  void onBlynkConnected() {
+    if (blynkUp) return;
+    blynkUp = true;
+    if (blynkEverConnected) blynkReconnectCount++;
+    blynkEverConnected = true;
+  }
+
+  void onBlynkDisconnected() {
+    if (!blynkUp) return;
+    blynkUp = false;
+    blynkDisconnectCount++;
+  }
+
+  // ---- Leituras em cache ----
+  bool wifiConnected() const { return wifiUp; }
+  bool blynkConnected() const { return blynkUp; }
+
+  uint32_t wifiDisconnects() const { return wifiDisconnectCount; }
+  uint32_t wifiReconnects() const { return wifiReconnectCount; }
+  uint32_t blynkDisconnects() const { return blynkDisconnectCount; }
+  uint32_t blynkReconnects() const { return blynkReconnectCount; }
+
+  // ---- Agenda de amostragem do RSSI ----
+  bool rssiDue(uint32_t nowMs) const {
+    return !rssiSampled || nowMs - lastRssiSample >= RSSI_SAMPLE_INTERVAL_MS;
+  }
+
+  void markRssiSampled(uint32_t nowMs) {
+    lastRssiSample = nowMs;
+    rssiSampled = true;
+  }
+
+#if defined(ARDUINO_ARCH_ESP32)
+  // Registra os eventos de WiFi (chamar antes de WiFi.begin)
+  void attachWifiEvents() {
+    WiFi.onEvent([this](WiFiEvent_t event, WiFiEventInfo_t info) {
+      switch (event) {
+        case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+          onWifiConnected();
+          break;
+        case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+        case ARDUINO_EVENT_WIFI_STA_LOST_IP:
+          onWifiDisconnected();
+          break;
+        default:
+          break;
+      }
+    });
+  }
+#endif
+
+private:
+  volatile bool wifiUp = false;
+  volatile bool blynkUp = false;
+  bool wifiEverConnected = false;
+  bool blynkEverConnected = false;
+
+  volatile uint32_t wifiDisconnectCount = 0;
+  volatile uint32_t wifiReconnectCount = 0;
+  volatile uint32_t blynkDisconnectCount = 0;
+  volatile uint32_t blynkReconnectCount = 0;
+
+  uint32_t lastRssiSample = 0;
+  bool rssiSampled = false;
+};
+
+// Contadores de transição (totais ou novos desde a última consulta)
+struct Counters {
+  uint32_t wifiDisconnects;
+  uint32_t wifiReconnects;
+  uint32_t blynkDisconnects;
+  uint32_t blynkReconnects;
+};
+
+// Transições ocorridas desde a consulta anterior. seen guarda os totais já
+// vistos pelo loop e é atualizado. Uma queda e a volta entre duas consultas
+// aparecem juntas.
+inline Counters pollChanges(const State& state, Counters& seen) {
+  Counters now = {state.wifiDisconnects(), state.wifiReconnects(),
+                  state.blynkDisconnects(), state.blynkReconnects()};
+  Counters changes = {now.wifiDisconnects - seen.wifiDisconnects,
+                      now.wifiReconnects - seen.wifiReconnects,
+                      now.blynkDisconnects - seen.blynkDisconnects,
+                      now.blynkReconnects - seen.blynkReconnects};
+  seen = now;
+  return changes;
+}
+
+}  // namespace connectivity
@@ -0,0 +1,160 @@
+// Caminho de dados dos sensores: conversão, filtragem e publicação
+//
+// Recebe as leituras brutas de um ciclo (RawSample) e produz os valores
+// publicados nos Virtual Pins (Published). O mesmo código roda no ESP32
+// (main.cpp) e no Linux (host/trace_replay.cpp), o que permite reproduzir
+// capturas de campo com saída idêntica bit a bit.
+//
+// As conversões seguem as bibliotecas originais:
+//   - AHT20/AHT21: Adafruit_AHTX0 (20 bits de umidade e temperatura)
+//   - BH1750: contagens / 1,2 no modo CONTINUOUS_HIGH_RES
+//   - Solo: map() do core ESP32 + limite de 0 a 100%
+
+#pragma once
+
+#include <stdint.h>
+#include "connectivity.h"
+
+#if defined(ARDUINO)
+#include <Wire.h>
+#endif
+
+namespace datapath {
+
+// Flags de RawSample
+const uint8_t AHT_OK = 0x01;        // Leitura AHT válida
+const uint8_t BH1750_OK = 0x02;     // Leitura BH1750 válida
+const uint8_t WIFI_UP = 0x04;
+const uint8_t BLYNK_UP = 0x08;
+const uint8_t RSSI_SAMPLED = 0x10;  // Nova amostra de RSSI neste ciclo
+
+// Entradas brutas de um ciclo de leitura
+struct RawSample {
+  uint32_t timestampMs;
+  uint8_t aht[6];      // Status + 20 bits umidade + 20 bits temperatura
+  uint16_t bh1750;     // Contagens do BH1750
+  uint16_t soilAdc;    // analogRead() do sensor de solo
+  int8_t rssi;         // dBm (válido com RSSI_SAMPLED)
+  uint8_t flags;
+};
+
+// Virtual Pins publicados (bit n = Vn)
+const uint8_t PIN_COUNT = 5;
+
+struct Published {
+  float values[PIN_COUNT];  // V0 temp, V1 umid, V2 luz, V3 solo, V4 RSSI
+  uint8_t mask;             // Pinos enviados ao Blynk neste ciclo
+};
+
+// ======================== CONVERSÕES ========================
+inline float ahtHumidity(const uint8_t* d) {
+  uint32_t h = ((uint32_t)d[1] << 12) | ((uint32_t)d[2] << 4) | (d[3] >> 4);
+  return ((float)h * 100) / 0x100000;
+}
+
+inline float ahtTemperature(const uint8_t* d) {
+  uint32_t t = ((uint32_t)(d[3] & 0x0F) << 16) | ((uint32_t)d[4] << 8) | d[5];
+  return ((float)t * 200 / 0x100000) - 50;
+}
+
+inline float bh1750Lux(uint16_t counts) {
+  return counts / 1.2f;
+}
+
+// map() do core ESP32 (divisão inteira)
+inline long mapRange(long x, long inMin, long inMax, long outMin, long outMax) {
+  const long run = inMax - inMin;
+  if (run == 0) return -1;
+  return ((x - inMin) * (outMax - outMin)) / run + outMin;
+}
+
+// ======================== PIPELINE ========================
+class Pipeline {
+public:
+  Pipeline(int soilDry, int soilWet) : soilDry(soilDry), soilWet(soilWet) {}
+
+  // Processa um ciclo. Retorna os valores atuais e os pinos a publicar.
+  void process(const RawSample& in, Published& out) {
+    out.mask = 0;
+    bool publish = in.flags & BLYNK_UP;
+
+    if (in.flags & AHT_OK) {
+      temperature = ahtTemperature(in.aht);
+      humidity = ahtHumidity(in.aht);
+      if (publish) out.mask |= 0x03;
+    }
+
+    if (in.flags & BH1750_OK) {
+      lightLevel = bh1750Lux(in.bh1750);
+      if (publish) out.mask |= 0x04;
+    }
+
+    // 0% = seco, 100% = molhado (valores maiores de ADC = mais seco)
+    soilMoisturePercent = mapRange(in.soilAdc, soilDry, soilWet, 0, 100);
+    if (soilMoisturePercent < 0) soilMoisturePercent = 0;
+    if (soilMoisturePercent > 100) soilMoisturePercent = 100;
+    if (publish) out.mask |= 0x08;
+
+    if (in.flags & RSSI_SAMPLED) {
+      rssiFilter.update(in.rssi);
+    }
+    if (in.flags & WIFI_UP) {
+      wifiRSSI = rssiFilter.value();
+      if (publish) out.mask |= 0x10;
+    }
+
+    out.values[0] = temperature;
+    out.values[1] = humidity;
+    out.values[2] = lightLevel;
+    out.values[3] = soilMoisturePercent;
+    out.values[4] = (float)wifiRSSI;
+  }
+
+  float temperature = 0.0;
+  float humidity = 0.0;
+  float lightLevel = 0.0;
+  float soilMoisturePercent = 0.0;
+  int wifiRSSI = 0;
+
+private:
+  int soilDry;
+  int soilWet;
+  connectivity::RssiFilter rssiFilter;
+};
+
+#if defined(ARDUINO)
+// ======================== LEITURA BRUTA (ESP32) ========================
+const uint8_t AHT_ADDRESS = 0x38;
+const uint8_t BH1750_ADDRESS = 0x23;
+
+// Dispara uma medição no AHT20/AHT21 e lê os 6 bytes brutos
+inline bool readAhtRaw(TwoWire& wire, uint8_t* out) {
+  wire.beginTransmission(AHT_ADDRESS);
+  wire.write(0xAC);
+  wire.write(0x33);
+  wire.write(0x00);
+  if (wire.endTransmission() != 0) return false;
+
+  // Aguarda o fim da conversão (bit 7 do status, ~80 ms)
+  unsigned long start = millis();
+  do {
+    delay(10);
+    if (wire.requestFrom(AHT_ADDRESS, (uint8_t)1) != 1) return false;
+    if (!(wire.read() & 0x80)) break;
+  } while (millis() - start < 200);
+
+  if (wire.requestFrom(AHT_ADDRESS, (uint8_t)6) != 6) return false;
+  for (uint8_t i = 0; i < 6; i++) out[i] = wire.read();
+  return !(out[0] & 0x80);
+}
+
+// Lê as contagens do BH1750 (modo contínuo já configurado por begin())
+inline bool readBh1750Raw(TwoWire& wire, uint16_t& counts) {
+  if (wire.requestFrom(BH1750_ADDRESS, (uint8_t)2) != 2) return false;
+  counts = (uint16_t)wire.read() << 8;
+  counts |= wire.read();
+  return true;
+}
+#endif
+
+}  // namespace datapath
@@ -0,0 +1,155 @@
+// Verificação e benchmark das métricas derivadas (agro.h) no Linux
+//
+// Compilar:  g++ -O2 -std=c++11 -I.. agro_bench.cpp -o agro_bench
+// Executar:  ./agro_bench [amostras]
+//
+// 1. Compara es(T), VPD e ponto de orvalho da tabela com as fórmulas de
+//    referência (exp/log em double) numa grade de -40 a 60 °C e 1 a 100 % UR,
+//    e o DLI com a integral exata de um dia sintético.
+// 2. Mede o custo por amostra de agro::Engine contra a versão com expf/logf.
+// Retorna 1 se algum erro passar dos limites documentados em agro.h.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <chrono>
+#include <vector>
+
+#include "agro.h"
+
+// Limites de erro (os mesmos de agro.h)
+const double MAX_ES_RELATIVE = 0.0005;
+const double MAX_VPD_KPA = 0.002;
+const double MAX_DEW_POINT_C = 0.01;
+const double MAX_DLI_RELATIVE = 0.0001;
+
+static double nowSeconds() {
+  using namespace std::chrono;
+  return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+// ======================== REFERÊNCIA ========================
+static double refSaturation(double t) {
+  return 0.6108 * exp(17.27 * t / (t + 237.3));
+}
+
+static double refDewPoint(double t, double rh) {
+  double g = log(rh / 100.0) + 17.27 * t / (t + 237.3);
+  return 237.3 * g / (17.27 - g);
+}
+
+// Versão direta em float, como seria escrita sem a tabela
+struct ReferenceFloat {
+  void update(float t, float rh) {
+    float g = 17.27f * t / (t + 237.3f);
+    float sat = 0.6108f * expf(g);
+    vpd = sat * (1.0f - rh * 0.01f);
+    g += logf(rh * 0.01f);
+    dewPoint = 237.3f * g / (17.27f - g);
+  }
+  float dewPoint = 0;
+  float vpd = 0;
+};
+
+static bool check(const char* name, double error, double limit, const char* unit) {
+  bool ok = error <= limit;
+  printf("  %-22s %.6f %s (limite %.6f) %s\n", name, error, unit, limit, ok ? "OK" : "FALHOU");
+  return ok;
+}
+
+int main(int argc, char** argv) {
+  uint32_t samples = argc > 1 ? (uint32_t)atol(argv[1]) : 10000000;
+
+  agro::Engine engine;
+  engine.begin();
+
+  // ---- Erro frente à referência ----
+  double esErr = 0, vpdErr = 0, dewErr = 0;
+  double worstT = 0, worstRh = 0;
+  for (int ti = 0; ti <= 10000; ti++) {
+    double t = -40.0 + ti * 0.01;
+    double sat = refSaturation(t);
+    double e = fabs(engine.saturationPressure((float)t) - sat) / sat;
+    if (e > esErr) esErr = e;
+
+    for (int rhi = 1; rhi <= 100; rhi++) {
+      double rh = rhi;
+      engine.updateClimate((float)t, (float)rh);
+      e = fabs(engine.vpd - sat * (1 - rh / 100));
+      if (e > vpdErr) vpdErr = e;
+
+      double td = refDewPoint(t, rh);
+      if (td < agro::TABLE_MIN_C) continue;  // Fora da tabela (limitado)
+      e = fabs(engine.dewPoint - td);
+      if (e > dewErr) {
+        dewErr = e;
+        worstT = t;
+        worstRh = rh;
+      }
+    }
+  }
+
+  // DLI: dia sintético (seno de 6h a 18h, pico de 100 klux) a cada ~2 s
+  double lightStart = 6 * 3600.0, lightEnd = 18 * 3600.0, peakLux = 100000;
+  double exact = peakLux * agro::LUX_TO_PPFD * (lightEnd - lightStart) * 2 / M_PI / 1e6;
+  agro::Engine dliEngine;
+  dliEngine.begin();
+  for (uint32_t ms = 0; ms < 86400000u; ms += 2000 + (ms / 2000) % 7) {
+    double s = ms / 1000.0;
+    double lux = (s > lightStart && s < lightEnd)
+               ? peakLux * sin(M_PI * (s - lightStart) / (lightEnd - lightStart)) : 0;
+    dliEngine.updateLight(ms, 1, (float)lux);
+  }
+  dliEngine.updateLight(86400000u, 2, 0);  // Virada do dia
+  double dliErr = fabs(dliEngine.previousDli - exact) / exact;
+
+  printf("--- Erro frente à referência ---\n");
+  bool ok = true;
+  ok &= check("es relativo", esErr, MAX_ES_RELATIVE, "");
+  ok &= check("VPD", vpdErr, MAX_VPD_KPA, "kPa");
+  ok &= check("Ponto de orvalho", dewErr, MAX_DEW_POINT_C, "°C");
+  printf("    (pior caso em T=%.2f °C, UR=%.0f %%)\n", worstT, worstRh);
+  ok &= check("DLI relativo", dliErr, MAX_DLI_RELATIVE, "");
+  printf("    (DLI %.4f mol/m²/dia, exato %.4f)\n", dliEngine.previousDli, exact);
+
+  // ---- Benchmark ----
+  std::vector<float> temps(4096), hums(4096);
+  srand(1);
+  for (size_t i = 0; i < temps.size(); i++) {
+    temps[i] = 10 + (rand() % 3000) / 100.0f;
+    hums[i] = 20 + (rand() % 7500) / 100.0f;
+  }
+
+  float sink = 0;  // Evita eliminar o laço
+  double t0 = nowSeconds();
+  for (uint32_t i = 0; i < samples; i++) {
+    uint32_t k = i & 4095;
+    engine.updateClimate(temps[k], hums[k]);
+    sink += engine.dewPoint + engine.vpd;
+  }
+  double tableTime = nowSeconds() - t0;
+
+  t0 = nowSeconds();
+  for (uint32_t i = 0; i < samples; i++) {
+    engine.updateLight(i * 2000, i / 43200, hums[i & 4095] * 100);
+    sink += engine.dli;
+  }
+  double dliTime = nowSeconds() - t0;
+
+  ReferenceFloat ref;
+  t0 = nowSeconds();
+  for (uint32_t i = 0; i < samples; i++) {
+    uint32_t k = i & 4095;
+    ref.update(temps[k], hums[k]);
+    sink += ref.dewPoint + ref.vpd;
+  }
+  double refTime = nowSeconds() - t0;
+
+  printf("\n--- Custo por amostra (%u amostras) ---\n", samples);
+  printf("Clima, tabela:    %.1f ns\n", tableTime * 1e9 / samples);
+  printf("Clima, expf/logf: %.1f ns\n", refTime * 1e9 / samples);
+  printf("DLI:              %.1f ns\n", dliTime * 1e9 / samples);
+  printf("Checksum: %.3f\n", sink);
+
+  return ok ? 0 : 1;
+}
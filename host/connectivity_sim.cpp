@@ -0,0 +1,182 @@
+// Simulação no Linux: estado de conexão por eventos x polling
+//
+// Compilar:  g++ -O2 -std=c++11 -I.. connectivity_sim.cpp -o connectivity_sim
+// Executar:  ./connectivity_sim [horas]
+//
+// Gera uma lista de quedas de WiFi e Blynk (incluindo quedas mais curtas que
+// um ciclo do loop), conta as quedas geradas ("Real") e as converte nos
+// eventos do sistema (o ESP32 repete DISCONNECTED a cada tentativa de
+// reconexão; o Blynk cai antes do WiFi). A cada ciclo de 100 ms compara:
+//   - polling: o loop antigo de main_teste.cpp, que compara WiFi.status() e
+//     Blynk.connected() com o ciclo anterior
+//   - main_teste: connectivity::State alimentado pelos eventos e consultado
+//     com pollChanges(), exatamente como o loop de main_teste.cpp; conta as
+//     linhas de log emitidas e os totais que vão para as métricas
+// O que se testa é a lógica do loop (descarte de eventos repetidos e
+// diferença de contadores por ciclo) frente às quedas geradas. A entrega dos
+// eventos pelo ESP32 não é simulada.
+//
+// Também conta as chamadas de WiFi.status()/Blynk.connected()/WiFi.RSSI() por
+// ciclo no loop antigo de main.cpp. O custo em ciclos de CPU de cada consulta
+// é medido no dispositivo por main_teste.cpp (ESP.getCycleCount()).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "connectivity.h"
+
+const uint32_t LOOP_PERIOD_MS = 100;          // delay(100) em main.cpp
+const uint32_t SENSOR_INTERVAL_MS = 2000;
+const uint32_t DISCONNECT_RETRY_MS = 1000;    // Repetição do evento DISCONNECTED
+
+enum EventType { WIFI_UP, WIFI_DOWN, BLYNK_UP, BLYNK_DOWN };
+
+struct Event {
+  uint32_t time;
+  EventType type;
+};
+
+using connectivity::Counters;
+
+static uint32_t randomRange(uint32_t lo, uint32_t hi) {
+  return lo + (uint32_t)(rand() % (hi - lo + 1));
+}
+
+// Linha do tempo: quedas de WiFi (derrubam o Blynk) e quedas só do Blynk
+static void generateTimeline(uint32_t durationMs, std::vector<Event>& events, Counters& truth) {
+  uint32_t t = 1000;
+  events.push_back({0, WIFI_UP});
+  events.push_back({500, BLYNK_UP});
+  while (true) {
+    t += randomRange(30000, 600000);
+    // 40% das quedas são mais curtas que um ciclo do loop
+    uint32_t outage = rand() % 10 < 4 ? randomRange(5, LOOP_PERIOD_MS - 10)
+                                      : randomRange(500, 20000);
+    if (t + outage + 2000 >= durationMs) break;
+
+    if (rand() % 3 == 0) {
+      events.push_back({t, BLYNK_DOWN});
+      events.push_back({t + outage, BLYNK_UP});
+      truth.blynkDisconnects++;
+      truth.blynkReconnects++;
+    } else {
+      events.push_back({t, BLYNK_DOWN});
+      events.push_back({t, WIFI_DOWN});
+      for (uint32_t r = t + DISCONNECT_RETRY_MS; r < t + outage; r += DISCONNECT_RETRY_MS) {
+        events.push_back({r, WIFI_DOWN});
+      }
+      events.push_back({t + outage, WIFI_UP});
+      events.push_back({t + outage + 1, BLYNK_UP});
+      truth.wifiDisconnects++;
+      truth.wifiReconnects++;
+      truth.blynkDisconnects++;
+      truth.blynkReconnects++;
+    }
+    t += outage;
+  }
+}
+
+static bool sameCounters(const Counters& a, const Counters& b) {
+  return a.wifiDisconnects == b.wifiDisconnects && a.wifiReconnects == b.wifiReconnects &&
+         a.blynkDisconnects == b.blynkDisconnects && a.blynkReconnects == b.blynkReconnects;
+}
+
+static void printCounters(const char* name, const Counters& c, const Counters& truth) {
+  printf("%-18s %10u %10u %10u %10u   %s\n", name, c.wifiDisconnects, c.wifiReconnects,
+         c.blynkDisconnects, c.blynkReconnects, sameCounters(c, truth) ? "OK" : "DIVERGE");
+}
+
+int main(int argc, char** argv) {
+  uint32_t hours = argc > 1 ? atoi(argv[1]) : 24;
+  uint32_t durationMs = hours * 3600000u;
+
+  srand(7);
+  std::vector<Event> events;
+  Counters truth = {};
+  generateTimeline(durationMs, events, truth);
+
+  // ---- Loop de main_teste.cpp: eventos + pollChanges() por ciclo ----
+  connectivity::State link;
+  Counters linkSeen = {};  // Totais que vão para as métricas
+  Counters logged = {};    // Linhas de log emitidas
+  uint32_t passesWithBoth = 0;  // Queda e volta vistas no mesmo ciclo
+  size_t next = 0;
+
+  // ---- Modelo por polling (loop antigo) ----
+  bool wifiUp = false, blynkUp = false;
+  bool wasWifiConnected = true, wasBlynkConnected = true;  // Após o setup()
+  Counters polling = {};
+
+  // Chamadas por ciclo (loop antigo de main.cpp x loop novo)
+  uint64_t passes = 0, oldStatus = 0, oldConnected = 0, oldRssi = 0, newRssi = 0;
+  uint32_t lastSensorRead = 0;
+
+  for (uint32_t now = 1000; now < durationMs; now += LOOP_PERIOD_MS) {
+    // Aplica os eventos ocorridos até agora (nos dois modelos)
+    while (next < events.size() && events[next].time <= now) {
+      switch (events[next].type) {
+        case WIFI_UP:    wifiUp = true;   link.onWifiConnected();     break;
+        case WIFI_DOWN:  wifiUp = false;  link.onWifiDisconnected();  break;
+        case BLYNK_UP:   blynkUp = true;  link.onBlynkConnected();    break;
+        case BLYNK_DOWN: blynkUp = false; link.onBlynkDisconnected(); break;
+      }
+      next++;
+    }
+
+    // main_teste.cpp: uma linha de log por transição nova
+    Counters changes = connectivity::pollChanges(link, linkSeen);
+    logged.wifiDisconnects += changes.wifiDisconnects;
+    logged.wifiReconnects += changes.wifiReconnects;
+    logged.blynkDisconnects += changes.blynkDisconnects;
+    logged.blynkReconnects += changes.blynkReconnects;
+    if ((changes.wifiDisconnects && changes.wifiReconnects) ||
+        (changes.blynkDisconnects && changes.blynkReconnects)) {
+      passesWithBoth++;
+    }
+
+    // Polling: só enxerga o estado no instante do ciclo
+    if (wasWifiConnected && !wifiUp) polling.wifiDisconnects++;
+    if (!wasWifiConnected && wifiUp) polling.wifiReconnects++;
+    if (wasBlynkConnected && !blynkUp) polling.blynkDisconnects++;
+    if (!wasBlynkConnected && blynkUp) polling.blynkReconnects++;
+    wasWifiConnected = wifiUp;
+    wasBlynkConnected = blynkUp;
+
+    // Chamadas do loop antigo de main.cpp
+    passes++;
+    oldStatus++;  // Verificação de reconexão
+    if (now - lastSensorRead >= SENSOR_INTERVAL_MS) {
+      lastSensorRead = now;
+      oldConnected += 4;  // Antes de cada grupo de virtualWrite
+      oldStatus += 2;     // Leitura do RSSI e exibição
+      if (wifiUp) {
+        oldRssi++;
+        if (blynkUp) oldConnected++;  // Envio do RSSI
+      }
+    }
+
+    // Loop novo: apenas o RSSI em agenda própria
+    if (link.wifiConnected() && link.rssiDue(now)) {
+      link.markRssiSampled(now);
+      newRssi++;
+    }
+  }
+
+  printf("Simulação: %u h, ciclo de %u ms, %zu eventos\n\n", hours, LOOP_PERIOD_MS, events.size());
+  printf("--- Contadores ---\n");
+  printf("%-18s %10s %10s %10s %10s\n", "", "WiFi desc", "WiFi rec", "Blynk desc", "Blynk rec");
+  printCounters("Real (geradas)", truth, truth);
+  printCounters("Polling", polling, truth);
+  printCounters("main_teste métricas", linkSeen, truth);
+  printCounters("main_teste log", logged, truth);
+  printf("Ciclos com queda e volta juntas: %u\n", passesWithBoth);
+
+  printf("\n--- Chamadas por ciclo do loop (antigo, contadas) ---\n");
+  printf("WiFi.status():     %.2f (substituída por leitura em cache)\n", oldStatus / (double)passes);
+  printf("Blynk.connected(): %.2f (substituída por leitura em cache)\n", oldConnected / (double)passes);
+  printf("WiFi.RSSI():       %.3f -> %.3f\n", oldRssi / (double)passes, newRssi / (double)passes);
+  printf("Custo por consulta: ver \"CUSTO DAS CONSULTAS DE CONEXÃO\" em main_teste.cpp\n");
+
+  return sameCounters(linkSeen, truth) && sameCounters(logged, truth) ? 0 : 1;
+}
@@ -0,0 +1,842 @@
+// Gerador de carga de frota no Linux: milhares de nós virtuais contra um
+// servidor local que fala o protocolo do Blynk
+//
+// Compilar:  g++ -O2 -std=c++11 -pthread -I.. fleet_load.cpp -o fleet_load
+// Executar:  ./fleet_load [opções]
+//   --dispositivos N    nós virtuais (padrão 2000)
+//   --threads N         workers do pool (padrão: núcleos)
+//   --politica P        imediato | uniforme | backoff (padrão imediato)
+//   --janela-ms N       janela de partida da política uniforme (padrão 5000)
+//   --ciclos N          ciclos de publicação por nó (padrão 20)
+//   --intervalo-ms N    intervalo entre ciclos (padrão 200, comprimido de 2000)
+//   --custo-login-us N  custo de CPU do servidor por login (padrão 200)
+//   --backlog N         backlog de listen() do servidor (padrão 128)
+//   --porta N           porta local (padrão 18080)
+//
+// Cenário: queda de energia em todo o site, todos os nós executam setup() ao
+// mesmo tempo. Cada nó:
+//   1. aguarda o atraso de partida da política
+//   2. conecta e envia LOGIN (como Blynk.begin); repete com a política em caso
+//      de falha ou timeout
+//   3. a cada ciclo executa datapath::Pipeline e envia os Virtual Pins
+//      (HARDWARE "vw") como o loop() do firmware
+//
+// Arquitetura:
+//   - servidor: uma thread epoll; LOGIN custa --custo-login-us de CPU
+//   - nós: máquinas de estado executadas num pool com roubo de tarefas
+//     (uma fila por worker; workers ociosos roubam do início das outras)
+//   - uma thread epoll de clientes e uma thread de timers apenas despacham
+//     tarefas para o pool
+//
+// Mede: duração da tempestade de conexões, latência de conexão por nó,
+// vazão agregada de publicação e latência de publicação (percentis).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "datapath.h"
+
+// ======================== PROTOCOLO BLYNK ========================
+// Cabeçalho: comando u8 | id u16 | tamanho u16 (big-endian)
+// Em RESPONSE o campo tamanho carrega o código de status.
+const uint8_t CMD_RESPONSE = 0;
+const uint8_t CMD_PING = 6;
+const uint8_t CMD_HARDWARE = 20;
+const uint8_t CMD_HW_LOGIN = 29;
+const uint16_t STATUS_SUCCESS = 200;
+const size_t FRAME_HEADER = 5;
+
+static size_t writeFrame(uint8_t* p, uint8_t cmd, uint16_t id, const char* body, uint16_t len) {
+  p[0] = cmd;
+  p[1] = id >> 8;
+  p[2] = id;
+  p[3] = len >> 8;
+  p[4] = len;
+  if (body) memcpy(p + FRAME_HEADER, body, len);
+  return FRAME_HEADER + (body ? len : 0);
+}
+
+// virtualWrite(pin, value): "vw\0<pin>\0<valor>"
+static size_t writeVirtualPin(uint8_t* p, uint16_t id, int pin, float value) {
+  char body[48];
+  int n = snprintf(body, sizeof(body), "vw%c%d%c%.3f", 0, pin, 0, value);
+  return writeFrame(p, CMD_HARDWARE, id, body, (uint16_t)n);
+}
+
+static int64_t nowNs() {
+  using namespace std::chrono;
+  return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+static void setNonBlocking(int fd) {
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+}
+
+// ======================== POOL COM ROUBO DE TAREFAS ========================
+typedef std::function<void()> Task;
+
+class WorkStealingPool {
+public:
+  explicit WorkStealingPool(unsigned threads) : queues(threads) {
+    for (unsigned i = 0; i < threads; i++) queues[i].reset(new Queue);
+    for (unsigned i = 0; i < threads; i++) workers.emplace_back(&WorkStealingPool::run, this, i);
+  }
+
+  ~WorkStealingPool() { stop(); }
+
+  // Espera as tarefas em execução terminarem e descarta as da fila
+  void stop() {
+    stopping = true;
+    idle.notify_all();
+    for (auto& t : workers) {
+      if (t.joinable()) t.join();
+    }
+    for (auto& q : queues) q->tasks.clear();
+  }
+
+  // De um worker: fila própria (LIFO). De fora: distribui em rodízio.
+  void submit(Task task) {
+    unsigned i = currentWorker >= 0 ? (unsigned)currentWorker
+                                    : next.fetch_add(1) % queues.size();
+    {
+      std::lock_guard<std::mutex> lock(queues[i]->mutex);
+      queues[i]->tasks.push_back(std::move(task));
+    }
+    idle.notify_one();
+  }
+
+  uint64_t stolenTasks() const { return stolen.load(); }
+
+private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  bool popLocal(unsigned i, Task& task) {
+    std::lock_guard<std::mutex> lock(queues[i]->mutex);
+    if (queues[i]->tasks.empty()) return false;
+    task = std::move(queues[i]->tasks.back());
+    queues[i]->tasks.pop_back();
+    return true;
+  }
+
+  bool steal(unsigned self, Task& task) {
+    for (size_t k = 1; k < queues.size(); k++) {
+      unsigned victim = (self + k) % queues.size();
+      std::lock_guard<std::mutex> lock(queues[victim]->mutex);
+      if (queues[victim]->tasks.empty()) continue;
+      task = std::move(queues[victim]->tasks.front());
+      queues[victim]->tasks.pop_front();
+      stolen++;
+      return true;
+    }
+    return false;
+  }
+
+  void run(unsigned self) {
+    currentWorker = (int)self;
+    while (!stopping) {
+      Task task;
+      if (popLocal(self, task) || steal(self, task)) {
+        task();
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(idleMutex);
+      idle.wait_for(lock, std::chrono::milliseconds(1));
+    }
+  }
+
+  std::vector<std::unique_ptr<Queue>> queues;
+  std::vector<std::thread> workers;
+  std::atomic<unsigned> next{0};
+  std::atomic<uint64_t> stolen{0};
+  std::atomic<bool> stopping{false};
+  std::mutex idleMutex;
+  std::condition_variable idle;
+  static thread_local int currentWorker;
+};
+
+thread_local int WorkStealingPool::currentWorker = -1;
+
+// ======================== TIMERS ========================
+// Entrega tarefas ao pool no instante agendado
+class TimerQueue {
+public:
+  explicit TimerQueue(WorkStealingPool& pool) : pool(pool), thread(&TimerQueue::run, this) {}
+
+  ~TimerQueue() { stop(); }
+
+  // Para a entrega; timers pendentes são descartados
+  void stop() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    wake.notify_all();
+    if (thread.joinable()) thread.join();
+  }
+
+  void schedule(int64_t atNs, Task task) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      timers.push(Timer{atNs, seq++, std::move(task)});
+    }
+    wake.notify_all();
+  }
+
+private:
+  struct Timer {
+    int64_t at;
+    uint64_t seq;
+    Task task;
+    bool operator>(const Timer& o) const { return at != o.at ? at > o.at : seq > o.seq; }
+  };
+
+  void run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+      if (timers.empty()) {
+        wake.wait(lock);
+        continue;
+      }
+      int64_t wait = timers.top().at - nowNs();
+      if (wait > 0) {
+        wake.wait_for(lock, std::chrono::nanoseconds(wait));
+        continue;
+      }
+      Task task = std::move(const_cast<Timer&>(timers.top()).task);
+      timers.pop();
+      lock.unlock();
+      pool.submit(std::move(task));
+      lock.lock();
+    }
+  }
+
+  WorkStealingPool& pool;
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> timers;
+  uint64_t seq = 0;
+  bool stopping = false;
+  std::thread thread;
+};
+
+// ======================== CONFIGURAÇÃO ========================
+enum Policy { POLICY_IMMEDIATE, POLICY_UNIFORM, POLICY_BACKOFF };
+
+struct Config {
+  uint32_t devices = 2000;
+  unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+  Policy policy = POLICY_IMMEDIATE;
+  uint32_t windowMs = 5000;
+  uint32_t cycles = 20;
+  uint32_t intervalMs = 200;
+  uint32_t loginCostUs = 200;
+  int backlog = 128;
+  uint16_t port = 18080;
+  uint32_t connectTimeoutMs = 2000;
+};
+
+static const char* policyName(Policy p) {
+  switch (p) {
+    case POLICY_UNIFORM: return "uniforme";
+    case POLICY_BACKOFF: return "backoff";
+    default: return "imediato";
+  }
+}
+
+// ======================== SERVIDOR LOCAL ========================
+struct Device;
+
+class StandInServer {
+public:
+  StandInServer(const Config& config, std::vector<std::unique_ptr<Device>>& devices)
+    : config(config), devices(devices) {}
+
+  bool start();
+  void stop() {
+    stopping = true;
+    thread.join();
+    close(listenFd);
+    close(epollFd);
+  }
+
+  std::atomic<uint64_t> logins{0};
+  std::atomic<uint64_t> hardwareMessages{0};
+  std::atomic<int64_t> lastLoginNs{0};
+
+private:
+  struct Connection {
+    int fd;
+    int device = -1;
+    std::vector<uint8_t> buffer;
+  };
+
+  void run();
+  void handleFrame(Connection& c, uint8_t cmd, uint16_t id, const uint8_t* body, uint16_t len);
+
+  const Config& config;
+  std::vector<std::unique_ptr<Device>>& devices;
+  int listenFd = -1;
+  int epollFd = -1;
+  std::atomic<bool> stopping{false};
+  std::thread thread;
+};
+
+// ======================== NÓ VIRTUAL ========================
+enum DeviceState { DEV_WAITING, DEV_CONNECTING, DEV_LOGIN_SENT, DEV_CONNECTED, DEV_DONE };
+
+struct Device {
+  Device(uint32_t index) : index(index), pipeline(2521, 1200), rng(index * 7919 + 1) {}
+
+  uint32_t index;
+  std::mutex mutex;
+  DeviceState state = DEV_WAITING;
+  int fd = -1;
+  uint32_t attempt = 0;
+  uint32_t cycle = 0;
+  uint16_t msgId = 1;
+  int64_t firstAttemptNs = 0;
+  int64_t connectedNs = 0;
+
+  // Último lote enviado: o servidor mede a latência ao receber o último frame
+  std::atomic<int64_t> batchSentNs{0};
+  std::atomic<uint16_t> batchLastId{0};
+  std::vector<int64_t> publishLatencyNs;  // Escrito só pela thread do servidor
+
+  datapath::Pipeline pipeline;
+  std::mt19937 rng;
+};
+
+bool StandInServer::start() {
+  listenFd = socket(AF_INET, SOCK_STREAM, 0);
+  int one = 1;
+  setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(config.port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (bind(listenFd, (sockaddr*)&addr, sizeof(addr)) != 0) return false;
+  if (listen(listenFd, config.backlog) != 0) return false;
+  setNonBlocking(listenFd);
+
+  epollFd = epoll_create1(0);
+  epoll_event ev = {};
+  ev.events = EPOLLIN;
+  ev.data.ptr = nullptr;
+  epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &ev);
+  thread = std::thread(&StandInServer::run, this);
+  return true;
+}
+
+void StandInServer::run() {
+  epoll_event events[256];
+  uint8_t chunk[4096];
+  while (!stopping) {
+    int n = epoll_wait(epollFd, events, 256, 10);
+    for (int i = 0; i < n; i++) {
+      if (events[i].data.ptr == nullptr) {
+        // Aceita todas as conexões pendentes
+        while (true) {
+          int fd = accept(listenFd, nullptr, nullptr);
+          if (fd < 0) break;
+          setNonBlocking(fd);
+          int one = 1;
+          setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+          Connection* c = new Connection;
+          c->fd = fd;
+          epoll_event ev = {};
+          ev.events = EPOLLIN;
+          ev.data.ptr = c;
+          epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev);
+        }
+        continue;
+      }
+
+      Connection* c = (Connection*)events[i].data.ptr;
+      ssize_t r;
+      bool closed = false;
+      while ((r = recv(c->fd, chunk, sizeof(chunk), 0)) > 0) {
+        c->buffer.insert(c->buffer.end(), chunk, chunk + r);
+      }
+      if (r == 0 || (r < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) closed = true;
+
+      // Processa os frames completos
+      size_t pos = 0;
+      while (c->buffer.size() - pos >= FRAME_HEADER) {
+        const uint8_t* p = c->buffer.data() + pos;
+        uint8_t cmd = p[0];
+        uint16_t id = (p[1] << 8) | p[2];
+        uint16_t len = (p[3] << 8) | p[4];
+        uint16_t bodyLen = cmd == CMD_RESPONSE ? 0 : len;
+        if (c->buffer.size() - pos < FRAME_HEADER + bodyLen) break;
+        handleFrame(*c, cmd, id, p + FRAME_HEADER, bodyLen);
+        pos += FRAME_HEADER + bodyLen;
+      }
+      c->buffer.erase(c->buffer.begin(), c->buffer.begin() + pos);
+
+      if (closed) {
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, c->fd, nullptr);
+        close(c->fd);
+        delete c;
+      }
+    }
+  }
+}
+
+void StandInServer::handleFrame(Connection& c, uint8_t cmd, uint16_t id,
+                                const uint8_t* body, uint16_t len) {
+  uint8_t reply[FRAME_HEADER];
+  switch (cmd) {
+    case CMD_HW_LOGIN: {
+      // Token "fleet-<índice>"
+      std::string token((const char*)body, len);
+      if (token.compare(0, 6, "fleet-") == 0) c.device = atoi(token.c_str() + 6);
+
+      // Custo de autenticação/carregamento do servidor (serializado)
+      int64_t until = nowNs() + config.loginCostUs * 1000LL;
+      while (nowNs() < until) {}
+
+      writeFrame(reply, CMD_RESPONSE, id, nullptr, STATUS_SUCCESS);
+      send(c.fd, reply, FRAME_HEADER, MSG_NOSIGNAL);
+      logins++;
+      lastLoginNs = nowNs();
+      break;
+    }
+    case CMD_PING:
+      writeFrame(reply, CMD_RESPONSE, id, nullptr, STATUS_SUCCESS);
+      send(c.fd, reply, FRAME_HEADER, MSG_NOSIGNAL);
+      break;
+    case CMD_HARDWARE:
+      hardwareMessages++;
+      if (c.device >= 0 && (size_t)c.device < devices.size()) {
+        Device& d = *devices[c.device];
+        if (id == d.batchLastId.load()) {
+          d.publishLatencyNs.push_back(nowNs() - d.batchSentNs.load());
+        }
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+// ======================== FROTA ========================
+class Fleet {
+public:
+  Fleet(const Config& config, std::vector<std::unique_ptr<Device>>& devices,
+        WorkStealingPool& pool, TimerQueue& timers)
+    : config(config), devices(devices), pool(pool), timers(timers) {
+    epollFd = epoll_create1(0);
+    reactor = std::thread(&Fleet::runReactor, this);
+  }
+
+  // Timers e tarefas na fila capturam this: param a entrega e esperam o
+  // pool antes de destruir a frota
+  ~Fleet() {
+    stopping = true;
+    reactor.join();
+    timers.stop();
+    pool.stop();
+    close(epollFd);
+  }
+
+  // Simula a volta da energia: todos os nós executam setup() agora
+  void powerOn() {
+    startNs = nowNs();
+    for (auto& d : devices) {
+      Device* dev = d.get();
+      timers.schedule(startNs + initialDelayNs(*dev), [this, dev] { startAttempt(*dev); });
+    }
+  }
+
+  bool finished() const { return doneCount.load() == devices.size(); }
+
+  // Registro no epoll: índice do nó e número da tentativa. Um evento
+  // despachado antes de failAttempt() pode rodar depois da tentativa
+  // seguinte já ter aberto outro socket; a tentativa no registro o descarta.
+  static uint64_t eventTag(const Device& d) { return (uint64_t)d.index << 32 | d.attempt; }
+
+  int64_t startNs = 0;
+  std::atomic<uint64_t> attempts{0};
+  std::atomic<uint64_t> failures{0};
+  std::atomic<uint64_t> staleEvents{0};
+  std::atomic<uint64_t> shortSends{0};
+  std::atomic<uint64_t> publishes{0};
+  std::atomic<int64_t> firstPublishNs{0};
+  std::atomic<int64_t> lastPublishNs{0};
+
+private:
+  int64_t initialDelayNs(Device& d) {
+    if (config.policy != POLICY_UNIFORM) return 0;
+    std::uniform_int_distribution<int64_t> dist(0, config.windowMs * 1000000LL);
+    return dist(d.rng);
+  }
+
+  // Atraso antes de uma nova tentativa após falha
+  int64_t retryDelayNs(Device& d) {
+    switch (config.policy) {
+      case POLICY_BACKOFF: {
+        // Backoff exponencial com jitter total: base 100 ms, teto 10 s
+        int64_t cap = std::min<int64_t>(10000, 100LL << std::min<uint32_t>(d.attempt, 7));
+        std::uniform_int_distribution<int64_t> dist(0, cap * 1000000LL);
+        return dist(d.rng);
+      }
+      case POLICY_UNIFORM: {
+        std::uniform_int_distribution<int64_t> dist(0, config.windowMs * 1000000LL);
+        return dist(d.rng);
+      }
+      default:
+        return 1000 * 1000000LL;  // Intervalo fixo de reconexão
+    }
+  }
+
+  void startAttempt(Device& d) {
+    std::lock_guard<std::mutex> lock(d.mutex);
+    if (d.state != DEV_WAITING) return;
+    if (d.firstAttemptNs == 0) d.firstAttemptNs = nowNs();
+    attempts++;
+
+    d.fd = socket(AF_INET, SOCK_STREAM, 0);
+    setNonBlocking(d.fd);
+    int one = 1;
+    setsockopt(d.fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(config.port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int r = connect(d.fd, (sockaddr*)&addr, sizeof(addr));
+    if (r != 0 && errno != EINPROGRESS) {
+      failAttempt(d);
+      return;
+    }
+
+    d.state = DEV_CONNECTING;
+    epoll_event ev = {};
+    ev.events = EPOLLOUT | EPOLLIN | EPOLLONESHOT;
+    ev.data.u64 = eventTag(d);
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, d.fd, &ev);
+
+    // Timeout da tentativa (conexão + login)
+    Device* dev = &d;
+    uint32_t attempt = d.attempt;
+    timers.schedule(nowNs() + config.connectTimeoutMs * 1000000LL, [this, dev, attempt] {
+      std::lock_guard<std::mutex> lock(dev->mutex);
+      if (dev->attempt == attempt &&
+          (dev->state == DEV_CONNECTING || dev->state == DEV_LOGIN_SENT)) {
+        failAttempt(*dev);
+      }
+    });
+  }
+
+  // Chamado com d.mutex travado
+  void failAttempt(Device& d) {
+    failures++;
+    if (d.fd >= 0) {
+      epoll_ctl(epollFd, EPOLL_CTL_DEL, d.fd, nullptr);
+      close(d.fd);
+      d.fd = -1;
+    }
+    d.state = DEV_WAITING;
+    d.attempt++;
+    Device* dev = &d;
+    timers.schedule(nowNs() + retryDelayNs(d), [this, dev] { startAttempt(*dev); });
+  }
+
+  void rearm(Device& d, uint32_t events) {
+    epoll_event ev = {};
+    ev.events = events | EPOLLONESHOT;
+    ev.data.u64 = eventTag(d);
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, d.fd, &ev);
+  }
+
+  // Evento de socket despachado pelo reator
+  void onSocketEvent(Device& d, uint32_t attempt, uint32_t events) {
+    std::lock_guard<std::mutex> lock(d.mutex);
+    if (d.fd < 0) return;
+    if (attempt != d.attempt) {
+      staleEvents++;  // Evento de uma tentativa anterior
+      return;
+    }
+
+    if (d.state == DEV_CONNECTING) {
+      int err = 0;
+      socklen_t len = sizeof(err);
+      getsockopt(d.fd, SOL_SOCKET, SO_ERROR, &err, &len);
+      if (err != 0 || (events & (EPOLLERR | EPOLLHUP))) {
+        failAttempt(d);
+        return;
+      }
+      // Blynk.begin(): LOGIN com o token
+      char token[24];
+      int n = snprintf(token, sizeof(token), "fleet-%u", d.index);
+      uint8_t frame[64];
+      size_t size = writeFrame(frame, CMD_HW_LOGIN, d.msgId++, token, (uint16_t)n);
+      if (send(d.fd, frame, size, MSG_NOSIGNAL) != (ssize_t)size) {
+        failAttempt(d);
+        return;
+      }
+      d.state = DEV_LOGIN_SENT;
+      rearm(d, EPOLLIN);
+      return;
+    }
+
+    uint8_t buf[256];
+    ssize_t r = recv(d.fd, buf, sizeof(buf), 0);
+    if (r == 0 || (r < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+      if (d.state == DEV_LOGIN_SENT) failAttempt(d);
+      return;
+    }
+
+    if (d.state == DEV_LOGIN_SENT && r >= (ssize_t)FRAME_HEADER && buf[0] == CMD_RESPONSE) {
+      uint16_t status = (buf[3] << 8) | buf[4];
+      if (status != STATUS_SUCCESS) {
+        failAttempt(d);
+        return;
+      }
+      d.state = DEV_CONNECTED;
+      d.connectedNs = nowNs();
+      // Primeiro ciclo com fase aleatória (os loops não são sincronizados)
+      std::uniform_int_distribution<int64_t> phase(0, config.intervalMs * 1000000LL);
+      Device* dev = &d;
+      uint32_t attempt = d.attempt;
+      timers.schedule(nowNs() + phase(d.rng),
+                      [this, dev, attempt] { publishCycle(*dev, attempt); });
+    }
+    rearm(d, EPOLLIN);
+  }
+
+  // Um ciclo do loop(): leitura sintética, datapath e virtualWrite
+  void publishCycle(Device& d, uint32_t attempt) {
+    std::lock_guard<std::mutex> lock(d.mutex);
+    if (d.state != DEV_CONNECTED || d.attempt != attempt) return;
+
+    datapath::RawSample raw = {};
+    raw.timestampMs = (uint32_t)((nowNs() - startNs) / 1000000);
+    uint32_t hum = 0x80000 + d.rng() % 4096;
+    uint32_t temp = 0x60000 + d.rng() % 4096;
+    raw.aht[1] = hum >> 12;
+    raw.aht[2] = hum >> 4;
+    raw.aht[3] = ((hum & 0x0F) << 4) | ((temp >> 16) & 0x0F);
+    raw.aht[4] = temp >> 8;
+    raw.aht[5] = temp;
+    raw.bh1750 = 500 + d.rng() % 100;
+    raw.soilAdc = 1800 + d.rng() % 50;
+    raw.rssi = -60 - (int)(d.rng() % 8);
+    raw.flags = datapath::AHT_OK | datapath::BH1750_OK | datapath::WIFI_UP |
+                datapath::BLYNK_UP | datapath::RSSI_SAMPLED;
+
+    datapath::Published out;
+    d.pipeline.process(raw, out);
+
+    uint8_t frames[64 * datapath::PIN_COUNT];
+    size_t size = 0;
+    uint16_t lastId = 0;
+    uint32_t count = 0;
+    for (uint8_t pin = 0; pin < datapath::PIN_COUNT; pin++) {
+      if (!(out.mask & (1 << pin))) continue;
+      lastId = d.msgId++;
+      size += writeVirtualPin(frames + size, lastId, pin, out.values[pin]);
+      count++;
+    }
+
+    int64_t sent = nowNs();
+    d.batchSentNs = sent;
+    d.batchLastId = lastId;
+    if (send(d.fd, frames, size, MSG_NOSIGNAL) != (ssize_t)size) {
+      // Envio parcial deixa um frame cortado no fluxo: reconecta
+      shortSends++;
+      failAttempt(d);
+      return;
+    }
+    publishes += count;
+    int64_t expected = 0;
+    firstPublishNs.compare_exchange_strong(expected, sent);
+    lastPublishNs = sent;
+
+    d.cycle++;
+    if (d.cycle >= config.cycles) {
+      epoll_ctl(epollFd, EPOLL_CTL_DEL, d.fd, nullptr);
+      shutdown(d.fd, SHUT_WR);
+      d.state = DEV_DONE;
+      doneCount++;
+      return;
+    }
+    Device* dev = &d;
+    timers.schedule(sent + config.intervalMs * 1000000LL,
+                    [this, dev, attempt] { publishCycle(*dev, attempt); });
+  }
+
+  void runReactor() {
+    epoll_event events[256];
+    while (!stopping) {
+      int n = epoll_wait(epollFd, events, 256, 10);
+      for (int i = 0; i < n; i++) {
+        uint64_t tag = events[i].data.u64;
+        Device* d = devices[tag >> 32].get();
+        uint32_t attempt = (uint32_t)tag;
+        uint32_t ev = events[i].events;
+        pool.submit([this, d, attempt, ev] { onSocketEvent(*d, attempt, ev); });
+      }
+    }
+  }
+
+  const Config& config;
+  std::vector<std::unique_ptr<Device>>& devices;
+  WorkStealingPool& pool;
+  TimerQueue& timers;
+  int epollFd;
+  std::atomic<bool> stopping{false};
+  std::atomic<size_t> doneCount{0};
+  std::thread reactor;
+};
+
+// ======================== RELATÓRIO ========================
+static double percentileMs(std::vector<int64_t>& v, double p) {
+  if (v.empty()) return 0;
+  size_t i = (size_t)(p / 100.0 * (v.size() - 1));
+  std::nth_element(v.begin(), v.begin() + i, v.end());
+  return v[i] / 1e6;
+}
+
+static bool parseArgs(int argc, char** argv, Config& c) {
+  for (int i = 1; i + 1 < argc; i += 2) {
+    const char* k = argv[i];
+    const char* v = argv[i + 1];
+    if (!strcmp(k, "--dispositivos")) c.devices = atoi(v);
+    else if (!strcmp(k, "--threads")) c.threads = std::max(1, atoi(v));
+    else if (!strcmp(k, "--janela-ms")) c.windowMs = atoi(v);
+    else if (!strcmp(k, "--ciclos")) c.cycles = std::max(1, atoi(v));
+    else if (!strcmp(k, "--intervalo-ms")) c.intervalMs = atoi(v);
+    else if (!strcmp(k, "--custo-login-us")) c.loginCostUs = atoi(v);
+    else if (!strcmp(k, "--backlog")) c.backlog = atoi(v);
+    else if (!strcmp(k, "--porta")) c.port = atoi(v);
+    else if (!strcmp(k, "--politica")) {
+      if (!strcmp(v, "imediato")) c.policy = POLICY_IMMEDIATE;
+      else if (!strcmp(v, "uniforme")) c.policy = POLICY_UNIFORM;
+      else if (!strcmp(v, "backoff")) c.policy = POLICY_BACKOFF;
+      else return false;
+    } else {
+      return false;
+    }
+  }
+  return (argc - 1) % 2 == 0;
+}
+
+int main(int argc, char** argv) {
+  Config config;
+  if (!parseArgs(argc, argv, config)) {
+    fprintf(stderr, "Opções inválidas (ver cabeçalho de fleet_load.cpp)\n");
+    return 1;
+  }
+
+  // Dois descritores por nó (cliente e servidor)
+  rlimit lim;
+  getrlimit(RLIMIT_NOFILE, &lim);
+  lim.rlim_cur = lim.rlim_max;
+  setrlimit(RLIMIT_NOFILE, &lim);
+  if (lim.rlim_cur < 2 * config.devices + 64) {
+    fprintf(stderr, "Limite de descritores (%lu) insuficiente para %u nós\n",
+            (unsigned long)lim.rlim_cur, config.devices);
+    return 1;
+  }
+
+  std::vector<std::unique_ptr<Device>> devices;
+  for (uint32_t i = 0; i < config.devices; i++) devices.emplace_back(new Device(i));
+
+  StandInServer server(config, devices);
+  if (!server.start()) {
+    fprintf(stderr, "Falha ao abrir a porta %u\n", config.port);
+    return 1;
+  }
+
+  printf("Frota: %u nós, %u threads, política %s", config.devices, config.threads,
+         policyName(config.policy));
+  if (config.policy == POLICY_UNIFORM) printf(" (janela %u ms)", config.windowMs);
+  printf("\nServidor: backlog %d, login %u us, %u ciclos a cada %u ms\n\n", config.backlog,
+         config.loginCostUs, config.cycles, config.intervalMs);
+
+  uint64_t stolen;
+  int64_t startNs;
+  uint64_t attempts, failures, staleEvents, shortSends, publishes;
+  int64_t firstPublish, lastPublish;
+  {
+    WorkStealingPool pool(config.threads);
+    TimerQueue timers(pool);
+    Fleet fleet(config, devices, pool, timers);
+    fleet.powerOn();
+    while (!fleet.finished()) std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    // Aguarda o servidor drenar os últimos frames
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    stolen = pool.stolenTasks();
+    startNs = fleet.startNs;
+    attempts = fleet.attempts;
+    failures = fleet.failures;
+    staleEvents = fleet.staleEvents;
+    shortSends = fleet.shortSends;
+    publishes = fleet.publishes;
+    firstPublish = fleet.firstPublishNs;
+    lastPublish = fleet.lastPublishNs;
+  }
+  server.stop();
+
+  std::vector<int64_t> connectNs, publishNs;
+  int64_t lastConnected = 0;
+  for (auto& d : devices) {
+    connectNs.push_back(d->connectedNs - startNs);
+    lastConnected = std::max(lastConnected, d->connectedNs);
+    publishNs.insert(publishNs.end(), d->publishLatencyNs.begin(), d->publishLatencyNs.end());
+    if (d->fd >= 0) close(d->fd);
+  }
+
+  printf("--- Tempestade de conexões ---\n");
+  printf("Duração (energia -> último login): %.1f ms\n", (lastConnected - startNs) / 1e6);
+  printf("Tentativas: %lu (%lu falhas/timeouts)\n", (unsigned long)attempts,
+         (unsigned long)failures);
+  printf("Eventos de tentativas anteriores descartados: %lu\n", (unsigned long)staleEvents);
+  printf("Logins no servidor: %lu\n", (unsigned long)server.logins.load());
+  printf("Tempo até conectar p50/p90/p99/máx: %.1f / %.1f / %.1f / %.1f ms\n",
+         percentileMs(connectNs, 50), percentileMs(connectNs, 90),
+         percentileMs(connectNs, 99), percentileMs(connectNs, 100));
+
+  double publishSeconds = (lastPublish - firstPublish) / 1e9;
+  printf("\n--- Publicação ---\n");
+  printf("Mensagens enviadas/recebidas: %lu / %lu\n", (unsigned long)publishes,
+         (unsigned long)server.hardwareMessages.load());
+  printf("Envios parciais (reconexão): %lu\n", (unsigned long)shortSends);
+  if (publishSeconds > 0) {
+    printf("Vazão agregada: %.0f mensagens/s\n", publishes / publishSeconds);
+  }
+  printf("Latência p50/p90/p99/máx: %.3f / %.3f / %.3f / %.3f ms\n",
+         percentileMs(publishNs, 50), percentileMs(publishNs, 90),
+         percentileMs(publishNs, 99), percentileMs(publishNs, 100));
+
+  printf("\n--- Pool ---\n");
+  printf("Tarefas roubadas entre workers: %lu\n", (unsigned long)stolen);
+  return 0;
+}
@@ -0,0 +1,215 @@
+// Tempo de ciclo com e sem log (logger.h) contra uma UART emulada
+//
+// Compilar:  g++ -O2 -std=c++11 -pthread -I.. logger_bench.cpp -o logger_bench
+//            g++ -O2 -std=c++11 -pthread -I.. -DLOG_LEVEL=LOG_LEVEL_NONE logger_bench.cpp -o logger_bench_none
+// Executar:  ./logger_bench [ciclos] [intervalo_ms]
+//            ./logger_bench_none [ciclos] [intervalo_ms]
+//
+// A UART emulada tem FIFO de 128 bytes esvaziada a 115200 baud (11,52
+// bytes/ms), como a Serial do ESP32. Cada ciclo emite, com as macros LOG_*,
+// as mesmas linhas do bloco de leituras de main.cpp e mede o tempo do
+// produtor (o loop). O modo vem do LOG_LEVEL da compilação:
+//   - INFO (padrão): logger assíncrono, drenado por outra thread (a task de
+//                    envio) respeitando o espaço livre da FIFO
+//   - NONE:          macros eliminadas pelo pré-processador, como no firmware
+//                    compilado com LOG_LEVEL_NONE
+// O binário INFO também mede o modo síncrono (as mesmas linhas escritas
+// direto na FIFO, esperando espaço: o Serial.print do código original) e uma
+// rajada sem intervalo, que mostra que o excesso é descartado e contado sem
+// bloquear.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <algorithm>
+
+#include "logger.h"
+
+const uint32_t FIFO_SIZE = 128;
+const double UART_BYTES_PER_MS = 115200 / 10 / 1000.0;
+
+static double nowMicros() {
+  using namespace std::chrono;
+  return duration<double, std::micro>(steady_clock::now().time_since_epoch()).count();
+}
+
+// ======================== UART EMULADA ========================
+class Uart {
+public:
+  void start() {
+    running = true;
+    worker = std::thread([this] {
+      double credit = 0;
+      while (running) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        credit += UART_BYTES_PER_MS;
+        uint32_t n = (uint32_t)credit;
+        credit -= n;
+        uint32_t level = fifoLevel.load();
+        if (n > level) n = level;
+        fifoLevel -= n;
+        sentBytes += n;
+      }
+    });
+  }
+
+  void stop() {
+    running = false;
+    worker.join();
+  }
+
+  int availableForWrite() const { return FIFO_SIZE - fifoLevel.load(); }
+
+  // Como HardwareSerial::write: espera espaço na FIFO
+  size_t write(const uint8_t* data, size_t len) {
+    (void)data;
+    size_t done = 0;
+    while (done < len) {
+      uint32_t space = FIFO_SIZE - fifoLevel.load();
+      uint32_t n = std::min<size_t>(space, len - done);
+      fifoLevel += n;
+      done += n;
+      if (done < len) std::this_thread::yield();
+    }
+    return len;
+  }
+
+  std::atomic<uint32_t> fifoLevel{0};
+  std::atomic<uint64_t> sentBytes{0};
+
+private:
+  std::atomic<bool> running{false};
+  std::thread worker;
+};
+
+Uart uart;
+
+// Task de envio: o equivalente a logger::drain() + vTaskDelay(1)
+struct DrainTask {
+  void start() {
+    running = true;
+    worker = std::thread([this] {
+      while (running) {
+        int space = uart.availableForWrite();
+        if (space > 0) logger::ring.drain(uart, space);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+    });
+  }
+  void stop() {
+    running = false;
+    worker.join();
+  }
+  std::atomic<bool> running{false};
+  std::thread worker;
+};
+
+// ======================== CICLO DE LEITURA ========================
+struct Readings {
+  float temperature, humidity, dewPoint, vpd, lightLevel, dli, soil;
+  int soilRaw, rssi;
+};
+
+enum Mode { MODE_LOG, MODE_SYNC };
+
+static void syncPrintf(const char* format, ...) {
+  char line[logger::MAX_MESSAGE];
+  va_list args;
+  va_start(args, format);
+  int n = vsnprintf(line, sizeof(line) - 1, format, args);
+  va_end(args);
+  line[n++] = '\n';
+  uart.write((const uint8_t*)line, n);
+}
+
+// Mesmas linhas de main.cpp (bloco "Leituras dos Sensores"). MODE_LOG usa a
+// macro LOG_INFO de logger.h, sujeita ao LOG_LEVEL da compilação.
+#define EMIT(...) \
+  do { \
+    if (mode == MODE_SYNC) syncPrintf("I: " __VA_ARGS__); \
+    else LOG_INFO(__VA_ARGS__); \
+  } while (0)
+
+static void cycle(Mode mode, const Readings& r) {
+  EMIT("--- Leituras dos Sensores ---");
+  EMIT("🌡️  Temperatura: %.1f °C", r.temperature);
+  EMIT("💧 Umidade Ar: %.1f %%", r.humidity);
+  EMIT("🌫️  Ponto de Orvalho: %.1f °C | VPD: %.2f kPa", r.dewPoint, r.vpd);
+  EMIT("☀️  Luminosidade: %.0f lux | DLI: %.2f mol/m²/dia", r.lightLevel, r.dli);
+  EMIT("🌱 Umidade Solo: %.0f %% (ADC: %d)", r.soil, r.soilRaw);
+  EMIT("📶 Sinal WiFi: %d dBm (%s)", r.rssi, "Muito Bom");
+}
+
+struct Result {
+  double minUs = 1e18, maxUs = 0, totalUs = 0;
+  uint32_t cycles = 0;
+};
+
+static Result run(Mode mode, uint32_t cycles, uint32_t intervalMs) {
+  Result res;
+  Readings r = {24.5f, 61.2f, 16.6f, 1.19f, 842, 12.37f, 47, 1897, -58};
+  for (uint32_t i = 0; i < cycles; i++) {
+    r.temperature += 0.1f;
+    r.lightLevel += 3;
+    double t0 = nowMicros();
+    cycle(mode, r);
+    double us = nowMicros() - t0;
+    res.minUs = std::min(res.minUs, us);
+    res.maxUs = std::max(res.maxUs, us);
+    res.totalUs += us;
+    res.cycles++;
+    if (intervalMs) std::this_thread::sleep_for(std::chrono::milliseconds(intervalMs));
+  }
+  // Espera a UART esvaziar antes do próximo modo
+  while (logger::ring.pending() > 0 || uart.fifoLevel.load() > 0) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  return res;
+}
+
+static void report(const char* name, const Result& r) {
+  printf("%-10s %10.1f %10.1f %10.1f\n", name, r.minUs, r.totalUs / r.cycles, r.maxUs);
+}
+
+int main(int argc, char** argv) {
+  uint32_t cycles = argc > 1 ? (uint32_t)atol(argv[1]) : 200;
+  uint32_t intervalMs = argc > 2 ? (uint32_t)atol(argv[2]) : 50;
+
+  uart.start();
+  DrainTask drainTask;
+  drainTask.start();
+
+  printf("UART emulada: FIFO %u bytes, %.2f bytes/ms\n", FIFO_SIZE, UART_BYTES_PER_MS);
+  printf("Ciclos: %u a cada %u ms\n\n", cycles, intervalMs);
+  printf("%-10s %10s %10s %10s\n", "Modo", "min (μs)", "méd (μs)", "máx (μs)");
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+  Result info = run(MODE_LOG, cycles, intervalMs);
+  uint32_t droppedInfo = logger::ring.dropped();
+  Result sync = run(MODE_SYNC, cycles, intervalMs);
+  report("INFO", info);
+  report("síncrono", sync);
+  printf("Descartadas em INFO: %u de %u\n", droppedInfo, logger::ring.messages() + droppedInfo);
+  printf("Pico do buffer: %u de %u bytes\n", logger::ring.highWater(), logger::BUFFER_SIZE);
+
+  // Rajada: ciclos sem intervalo, bem acima da vazão da UART
+  uint32_t messagesBefore = logger::ring.messages();
+  Result burst = run(MODE_LOG, 1000, 0);
+  printf("\nRajada de %u ciclos sem intervalo:\n", burst.cycles);
+  report("INFO", burst);
+  printf("Enfileiradas: %u, descartadas: %u\n", logger::ring.messages() - messagesBefore,
+         logger::ring.dropped() - droppedInfo);
+#else
+  Result none = run(MODE_LOG, cycles, intervalMs);
+  report("NONE", none);
+  printf("Mensagens enfileiradas: %u\n", logger::ring.messages());
+#endif
+
+  drainTask.stop();
+  uart.stop();
+  return 0;
+}
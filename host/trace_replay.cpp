@@ -0,0 +1,242 @@
+// Reprodução de traces de leituras brutas (trace.h) no Linux
+//
+// Compilar:  g++ -O2 -std=c++11 -I.. trace_replay.cpp -o trace_replay
+// Executar:  ./trace_replay [-n repetições] <trace_000.bin> [trace_001.bin ...]
+//            ./trace_replay --gerar <prefixo> <amostras> [boots]
+//
+// Cada arquivo é um boot do dispositivo: passa seus registros por um
+// datapath::Pipeline novo (como o firmware após o reset), sem esperar o
+// sensorReadInterval, e mede amostras por segundo. Se o trace contém as
+// saídas publicadas pelo dispositivo (TRACE_HAS_OUTPUTS), confere a
+// reprodução bit a bit e informa as divergências. Passe os arquivos na
+// ordem dos boots.
+//
+// --gerar cria um trace sintético (com saídas) de vários boots, um arquivo
+// por boot (<prefixo>_000.bin, ...), com falhas ocasionais de leitura. Com
+// mais de um boot, a verificação também mostra as divergências de um
+// Pipeline único sem reinício, que é o erro que um arquivo contínuo causaria.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "trace.h"
+
+// Mesma calibração de main.cpp
+const int SOIL_DRY_VALUE = 2521;
+const int SOIL_WET_VALUE = 1200;
+
+// Um arquivo de trace (um boot)
+struct Session {
+  std::string path;
+  trace::Header header;
+  std::vector<uint8_t> data;
+  const uint8_t* records;
+  uint32_t stride;
+  size_t count;
+  bool hasOutputs;
+};
+
+static double nowSeconds() {
+  using namespace std::chrono;
+  return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+static bool sameOutput(const datapath::Published& a, const datapath::Published& b) {
+  return a.mask == b.mask && memcmp(a.values, b.values, sizeof(a.values)) == 0;
+}
+
+static int generate(const char* prefix, uint32_t count, uint32_t boots) {
+  uint8_t buf[trace::RECORD_SIZE + trace::OUTPUT_SIZE];
+  srand(1);
+  uint32_t clock = 0;  // Tempo real (s), contínuo entre boots
+  for (uint32_t b = 0; b < boots; b++) {
+    char path[256];
+    snprintf(path, sizeof(path), "%s_%03u.bin", prefix, b);
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+      fprintf(stderr, "Falha ao criar %s\n", path);
+      return 1;
+    }
+
+    trace::Header h = {trace::TRACE_VERSION, trace::TRACE_HAS_OUTPUTS,
+                       SOIL_DRY_VALUE, SOIL_WET_VALUE, 2000};
+    encodeHeader(h, buf);
+    fwrite(buf, 1, trace::HEADER_SIZE, f);
+
+    // Novo boot: Pipeline novo e millis() recomeçando
+    datapath::Pipeline pipeline(SOIL_DRY_VALUE, SOIL_WET_VALUE);
+    uint32_t ts = 1000 + rand() % 3000;
+    uint32_t samples = count / boots + (b < count % boots ? 1 : 0);
+    for (uint32_t i = 0; i < samples; i++) {
+      uint32_t step = 2000 + rand() % 110;
+      ts += step;
+      clock += step / 1000;
+      double sun = sin(fmod(clock, 86400.0) / 86400.0 * 2 * M_PI);
+
+      datapath::RawSample s = {};
+      s.timestampMs = ts;
+      uint32_t hum = (uint32_t)((55 - 15 * sun) / 100 * 0x100000) + rand() % 64;
+      uint32_t temp = (uint32_t)((24 + 6 * sun + 50) / 200 * 0x100000) + rand() % 64;
+      s.aht[0] = 0x1C;
+      s.aht[1] = hum >> 12;
+      s.aht[2] = hum >> 4;
+      s.aht[3] = ((hum & 0x0F) << 4) | ((temp >> 16) & 0x0F);
+      s.aht[4] = temp >> 8;
+      s.aht[5] = temp;
+      s.bh1750 = sun > 0 ? (uint16_t)(1000 * sun + rand() % 20) : 0;
+      s.soilAdc = 1800 + rand() % 40;
+      s.flags = datapath::WIFI_UP;
+      // Falhas ocasionais de leitura (mais prováveis logo após o boot)
+      if (rand() % (i < 3 ? 2 : 200) != 0) s.flags |= datapath::AHT_OK;
+      if (rand() % (i < 3 ? 2 : 300) != 0) s.flags |= datapath::BH1750_OK;
+      if (rand() % 100 != 0) s.flags |= datapath::BLYNK_UP;
+      if (i % 3 == 0) {
+        s.rssi = -60 - rand() % 8 - (int)(b % 4) * 5;
+        s.flags |= datapath::RSSI_SAMPLED;
+      }
+
+      datapath::Published out;
+      pipeline.process(s, out);
+      trace::encodeRecord(s, buf);
+      trace::encodeOutput(out, buf + trace::RECORD_SIZE);
+      fwrite(buf, 1, sizeof(buf), f);
+    }
+    fclose(f);
+    printf("Trace sintético: %s (%u amostras)\n", path, samples);
+    clock += 30 + rand() % 600;  // Tempo até o próximo boot
+  }
+  return 0;
+}
+
+static bool load(const char* path, Session& s) {
+  FILE* f = fopen(path, "rb");
+  if (!f) {
+    fprintf(stderr, "Falha ao abrir %s\n", path);
+    return false;
+  }
+  uint8_t chunk[65536];
+  size_t n;
+  while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) s.data.insert(s.data.end(), chunk, chunk + n);
+  fclose(f);
+
+  if (s.data.size() < trace::HEADER_SIZE || !trace::decodeHeader(s.data.data(), s.header)) {
+    fprintf(stderr, "Cabeçalho de trace inválido: %s\n", path);
+    return false;
+  }
+  s.path = path;
+  s.hasOutputs = s.header.flags & trace::TRACE_HAS_OUTPUTS;
+  s.stride = trace::RECORD_SIZE + (s.hasOutputs ? trace::OUTPUT_SIZE : 0);
+  s.count = (s.data.size() - trace::HEADER_SIZE) / s.stride;
+  s.records = s.data.data() + trace::HEADER_SIZE;
+  return true;
+}
+
+// Confere as saídas de uma sessão. Retorna o número de divergências.
+static size_t verify(const Session& s, datapath::Pipeline& pipeline, bool print) {
+  size_t mismatches = 0;
+  for (size_t i = 0; i < s.count; i++) {
+    datapath::RawSample in;
+    datapath::Published expected, out;
+    trace::decodeRecord(s.records + i * s.stride, in);
+    trace::decodeOutput(s.records + i * s.stride + trace::RECORD_SIZE, expected);
+    pipeline.process(in, out);
+    if (!sameOutput(out, expected)) {
+      if (print && mismatches < 5) {
+        printf("  Divergência em %s, amostra %zu (t=%u ms)\n", s.path.c_str(), i, in.timestampMs);
+      }
+      mismatches++;
+    }
+  }
+  return mismatches;
+}
+
+int main(int argc, char** argv) {
+  if (argc >= 4 && strcmp(argv[1], "--gerar") == 0) {
+    uint32_t boots = argc > 4 ? (uint32_t)atol(argv[4]) : 1;
+    return generate(argv[2], (uint32_t)atol(argv[3]), boots < 1 ? 1 : boots);
+  }
+
+  int repeats = 10;
+  int first = 1;
+  if (argc > 2 && strcmp(argv[1], "-n") == 0) {
+    repeats = atoi(argv[2]);
+    first = 3;
+  }
+  if (first >= argc) {
+    fprintf(stderr, "Uso: %s [-n repetições] <trace_000.bin> [trace_001.bin ...]\n", argv[0]);
+    fprintf(stderr, "     %s --gerar <prefixo> <amostras> [boots]\n", argv[0]);
+    return 1;
+  }
+
+  std::vector<Session> sessions(argc - first);
+  size_t total = 0;
+  bool allOutputs = true;
+  for (int i = first; i < argc; i++) {
+    Session& s = sessions[i - first];
+    if (!load(argv[i], s)) return 1;
+    total += s.count;
+    allOutputs = allOutputs && s.hasOutputs;
+    printf("%s: %zu amostras (%.1f h a cada %u ms), solo seco=%d molhado=%d\n",
+           s.path.c_str(), s.count, s.count * (double)s.header.intervalMs / 3600000.0,
+           s.header.intervalMs, s.header.soilDry, s.header.soilWet);
+  }
+  printf("Boots: %zu, amostras: %zu\n", sessions.size(), total);
+
+  // ---- Verificação bit a bit (Pipeline novo a cada boot) ----
+  size_t mismatches = 0;
+  if (allOutputs) {
+    printf("\n--- Verificação ---\n");
+    for (const Session& s : sessions) {
+      datapath::Pipeline pipeline(s.header.soilDry, s.header.soilWet);
+      mismatches += verify(s, pipeline, true);
+    }
+    printf("Divergências: %zu de %zu\n", mismatches, total);
+
+    if (sessions.size() > 1) {
+      const trace::Header& h = sessions[0].header;
+      datapath::Pipeline single(h.soilDry, h.soilWet);
+      size_t continuous = 0;
+      for (const Session& s : sessions) continuous += verify(s, single, false);
+      printf("Pipeline único sem reinício entre boots: %zu divergências\n", continuous);
+    }
+  }
+
+  // ---- Benchmark ----
+  uint32_t checksum = 2166136261u;  // FNV-1a das saídas (evita eliminar o laço)
+  double t0 = nowSeconds();
+  for (int r = 0; r < repeats; r++) {
+    for (const Session& s : sessions) {
+      datapath::Pipeline pipeline(s.header.soilDry, s.header.soilWet);
+      for (size_t i = 0; i < s.count; i++) {
+        datapath::RawSample in;
+        datapath::Published out;
+        trace::decodeRecord(s.records + i * s.stride, in);
+        pipeline.process(in, out);
+        checksum = (checksum ^ out.mask) * 16777619u;
+        for (uint8_t p = 0; p < datapath::PIN_COUNT; p++) {
+          uint32_t bits;
+          memcpy(&bits, &out.values[p], sizeof(bits));
+          checksum = (checksum ^ bits) * 16777619u;
+        }
+      }
+    }
+  }
+  double elapsed = nowSeconds() - t0;
+  double samples = (double)total * repeats;
+  uint32_t intervalMs = sessions[0].header.intervalMs;
+
+  printf("\n--- Reprodução ---\n");
+  printf("Repetições: %d (%.0f amostras)\n", repeats, samples);
+  printf("Vazão: %.2f M amostras/s (%.1f ns/amostra)\n", samples / elapsed / 1e6,
+         elapsed * 1e9 / samples);
+  printf("Equivalente a %.0f dias de captura por segundo\n",
+         samples / elapsed * intervalMs / 86400000.0);
+  printf("Checksum: %08x\n", checksum);
+
+  return mismatches == 0 ? 0 : 1;
+}
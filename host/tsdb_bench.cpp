@@ -0,0 +1,277 @@
+// Benchmark do armazenamento de séries temporais (timeseries.h) no Linux
+//
+// Compilar:  g++ -O2 -std=c++11 -I.. tsdb_bench.cpp -o tsdb_bench
+// Executar:  ./tsdb_bench [leituras.csv]
+//
+// O CSV deve ter uma amostra por linha:
+//   timestamp_s,temperatura,umidade,luminosidade,solo,rssi
+// Sem arquivo, gera 3 semanas de dados sintéticos a cada ~2 segundos
+// (ciclo diário de temperatura/luz, solo secando e irrigação, RSSI ruidoso
+// amostrado a cada 5 s e suavizado como no firmware) com três níveis de
+// ruído nos sensores:
+//   - suave:          abaixo das bandas mortas (limite otimista)
+//   - repetibilidade: AHT20 σ 0,1 °C / 0,1 %UR (repetibilidade do datasheet),
+//                     BH1750 σ 1 lx + 2 % (o datasheet não especifica ruído),
+//                     ADC do solo σ 10 contagens
+//   - exatidão:       AHT20 σ 0,3 °C / 2 %UR, BH1750 σ 20 % (exatidão do
+//                     datasheet tratada como ruído: limite pessimista)
+//
+// Mede: taxa de compressão, erro de cada canal frente a maxError(), vazão de
+// escrita, amostras recuperadas após um reset sem flush() e latência das
+// consultas (a última só no primeiro cenário).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "timeseries.h"
+#include "connectivity.h"
+
+// Mesmo tamanho da partição "tsdb" em partitions.csv
+const uint32_t STORAGE_BLOCKS = 0xC0000 / tsdb::BLOCK_SIZE;
+
+// Mesma calibração de main.cpp (faixa do ADC do solo)
+const float SOIL_ADC_RANGE = 2521 - 1200;
+
+// Desvio padrão do ruído de cada sensor (0 = ruído uniforme pequeno, suave)
+struct Noise {
+  const char* name;
+  float temperature;  // °C
+  float humidity;     // %UR
+  float luxAbsolute;  // lux
+  float luxRelative;  // fração da leitura
+  float soilCounts;   // contagens do ADC
+};
+
+const Noise SCENARIOS[] = {
+  {"suave",          0.0f, 0.0f, 0.0f, 0.0f,  0.0f},
+  {"repetibilidade", 0.1f, 0.1f, 1.0f, 0.02f, 10.0f},
+  {"exatidão",       0.3f, 2.0f, 1.0f, 0.20f, 10.0f},
+};
+
+struct Sample {
+  uint32_t ts;
+  float values[tsdb::CHANNEL_COUNT];
+};
+
+static double nowSeconds() {
+  using namespace std::chrono;
+  return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+static bool loadCsv(const char* path, std::vector<Sample>& out) {
+  FILE* f = fopen(path, "r");
+  if (!f) return false;
+  char line[256];
+  while (fgets(line, sizeof(line), f)) {
+    Sample s;
+    if (sscanf(line, "%u,%f,%f,%f,%f,%f", &s.ts, &s.values[0], &s.values[1],
+               &s.values[2], &s.values[3], &s.values[4]) == 6) {
+      out.push_back(s);
+    }
+  }
+  fclose(f);
+  return true;
+}
+
+static void generateSynthetic(std::vector<Sample>& out, uint32_t days, const Noise& noise) {
+  srand(42);
+  std::mt19937 rng(42);
+  std::normal_distribution<float> gauss(0.0f, 1.0f);
+  uint64_t tsMs = 1700000000ull * 1000;
+  uint64_t endMs = tsMs + (uint64_t)days * 86400 * 1000;
+  float soil = 80;
+  connectivity::RssiFilter rssi;
+  uint64_t nextRssiMs = 0;
+  while (tsMs < endMs) {
+    // Intervalo de 2 s + atraso do loop (delay(100) e envio)
+    tsMs += 2000 + rand() % 120;
+    double day = fmod(tsMs / 1000.0, 86400.0) / 86400.0;
+    double sun = sin((day - 0.25) * 2 * M_PI);
+
+    Sample s;
+    s.ts = (uint32_t)(tsMs / 1000);
+    s.values[0] = 24 + 6 * sun + (rand() % 100) / 2000.0f;
+    s.values[1] = 60 - 15 * sun + (rand() % 100) / 1000.0f;
+    s.values[2] = sun > 0 ? (float)(800 * sun + rand() % 20) : 0;
+    soil -= 0.0004f;
+    if (soil < 30) soil = 85;  // Irrigação
+    float soilRead = soil;
+    if (noise.temperature > 0) {
+      s.values[0] += noise.temperature * gauss(rng);
+      s.values[1] += noise.humidity * gauss(rng);
+      float lux = s.values[2] + (noise.luxAbsolute + noise.luxRelative * s.values[2]) * gauss(rng);
+      s.values[2] = lux > 0 ? roundf(lux) : 0;  // Resolução de 1 lx
+      soilRead += noise.soilCounts * gauss(rng) * 100 / SOIL_ADC_RANGE;
+    }
+    s.values[3] = roundf(soilRead);
+    if (tsMs >= nextRssiMs) {
+      rssi.update(-62 - rand() % 5);
+      nextRssiMs = tsMs + connectivity::RSSI_SAMPLE_INTERVAL_MS;
+    }
+    s.values[4] = (float)rssi.value();
+    out.push_back(s);
+  }
+}
+
+struct VerifyContext {
+  const std::vector<Sample>* samples;
+  size_t next;
+  size_t mismatches;
+  float worst[tsdb::CHANNEL_COUNT];  // Maior erro / maxError() por canal
+};
+
+static void verifySample(uint32_t ts, const float* values, void* ctx) {
+  VerifyContext* v = (VerifyContext*)ctx;
+  // scan() entrega em ordem cronológica: avança até o timestamp lido
+  while (v->next < v->samples->size() && (*v->samples)[v->next].ts < ts) v->next++;
+  if (v->next >= v->samples->size()) { v->mismatches++; return; }
+  const Sample& s = (*v->samples)[v->next];
+  bool ok = true;
+  for (uint8_t c = 0; c < tsdb::CHANNEL_COUNT; c++) {
+    float bound = tsdb::maxError(c, s.values[c]);
+    float ratio = fabsf(values[c] - s.values[c]) / bound;
+    if (ratio > v->worst[c]) v->worst[c] = ratio;
+    if (ratio > 1.0001f) ok = false;
+  }
+  if (!ok) v->mismatches++;
+  v->next++;
+}
+
+static void countSample(uint32_t, const float*, void* ctx) {
+  (*(size_t*)ctx)++;
+}
+
+struct Result {
+  double bytesPerSample;
+  double days;  // Capacidade estimada da partição a cada 2 s
+  size_t mismatches;
+};
+
+static Result run(const std::vector<Sample>& samples, bool queries) {
+  std::vector<uint8_t> flash(STORAGE_BLOCKS * tsdb::BLOCK_SIZE);
+  std::vector<tsdb::BlockIndex> index(STORAGE_BLOCKS);
+  tsdb::MemoryStorage storage(flash.data(), STORAGE_BLOCKS);
+  tsdb::Store* store = new tsdb::Store(storage, index.data(), STORAGE_BLOCKS);
+  Result result = {0, 0, 1};
+  if (!store->begin()) {
+    fprintf(stderr, "Falha ao iniciar o armazenamento\n");
+    delete store;
+    return result;
+  }
+
+  // ---- Escrita ----
+  double t0 = nowSeconds();
+  for (size_t i = 0; i < samples.size(); i++) {
+    store->append(samples[i].ts, samples[i].values);
+  }
+  double appendTime = nowSeconds() - t0;
+
+  uint32_t sealed = store->sealedBlocks();
+  uint64_t bytes = (uint64_t)sealed * tsdb::BLOCK_SIZE + store->activeBytes();
+  uint32_t first = samples.front().ts;
+  uint32_t last = samples.back().ts;
+
+  // Amostras ainda armazenadas (o anel pode ter descartado as mais antigas)
+  size_t stored = 0;
+  store->scan(0, 0xFFFFFFFF, countSample, &stored);
+  double rawBytes = stored * (4.0 + 4.0 * tsdb::CHANNEL_COUNT);
+  result.bytesPerSample = bytes / (double)stored;
+  result.days = STORAGE_BLOCKS * (double)tsdb::BLOCK_SIZE / result.bytesPerSample * 2 / 86400;
+
+  printf("--- Compressão ---\n");
+  printf("Blocos usados: %u de %u (%u KB)\n", sealed, store->blockCapacity(),
+         STORAGE_BLOCKS * tsdb::BLOCK_SIZE / 1024);
+  printf("Amostras armazenadas: %zu de %zu\n", stored, samples.size());
+  printf("Bytes por amostra (5 canais + timestamp): %.2f\n", result.bytesPerSample);
+  printf("Taxa de compressão: %.1fx\n", rawBytes / bytes);
+  printf("Capacidade estimada a cada 2 s: %.1f dias\n", result.days);
+
+  printf("\n--- Escrita ---\n");
+  printf("Vazão: %.2f M amostras/s (%.0f ns/amostra)\n",
+         samples.size() / appendTime / 1e6, appendTime * 1e9 / samples.size());
+
+  // ---- Verificação ----
+  VerifyContext verify = {&samples, 0, 0, {0}};
+  store->scan(0, 0xFFFFFFFF, verifySample, &verify);
+  result.mismatches = verify.mismatches;
+  printf("\n--- Verificação ---\n");
+  printf("Amostras fora de maxError(): %zu\n", verify.mismatches);
+  const char* names[tsdb::CHANNEL_COUNT] = {"temperatura", "umidade", "luz", "solo", "rssi"};
+  for (uint8_t c = 0; c < tsdb::CHANNEL_COUNT; c++) {
+    printf("  %-12s pior erro = %.0f%% do limite\n", names[c], verify.worst[c] * 100);
+  }
+
+  // ---- Queda de energia ----
+  // Store novo sobre a mesma flash, sem flush(): como após um reset
+  std::vector<tsdb::BlockIndex> rebootIndex(STORAGE_BLOCKS);
+  tsdb::Store* rebooted = new tsdb::Store(storage, rebootIndex.data(), STORAGE_BLOCKS);
+  size_t recovered = 0;
+  if (rebooted->begin()) rebooted->scan(0, 0xFFFFFFFF, countSample, &recovered);
+  printf("\n--- Queda de energia ---\n");
+  printf("Amostras após reset sem flush(): %zu de %zu (%zu perdidas)\n", recovered, stored,
+         stored - recovered);
+  delete rebooted;
+
+  // ---- Consultas ----
+  if (queries) {
+    printf("\n--- Consultas (temperatura) ---\n");
+    static tsdb::Bucket buckets[2048];
+    struct Query { const char* name; uint32_t range; uint32_t bucket; };
+    const Query list[] = {
+      {"Última hora, 1 min", 3600, 60},
+      {"Último dia, 15 min", 86400, 900},
+      {"Última semana, 1 h", 7 * 86400, 3600},
+      {"Tudo, 1 dia", last - first + 1, 86400},
+    };
+    for (size_t q = 0; q < sizeof(list) / sizeof(list[0]); q++) {
+      uint32_t from = last - list[q].range + 1;
+      const int reps = 20;
+      uint32_t n = 0;
+      t0 = nowSeconds();
+      for (int r = 0; r < reps; r++) {
+        n = store->downsample(tsdb::CH_TEMPERATURE, from, last, list[q].bucket, buckets, 2048);
+      }
+      double latency = (nowSeconds() - t0) / reps;
+      printf("%-22s %5u buckets  %9.1f us\n", list[q].name, n, latency * 1e6);
+    }
+  }
+
+  delete store;
+  return result;
+}
+
+int main(int argc, char** argv) {
+  if (argc > 1) {
+    std::vector<Sample> samples;
+    if (!loadCsv(argv[1], samples) || samples.empty()) {
+      fprintf(stderr, "Falha ao ler %s\n", argv[1]);
+      return 1;
+    }
+    printf("Dados: %s (%zu amostras)\n\n", argv[1], samples.size());
+    return run(samples, true).mismatches == 0 ? 0 : 1;
+  }
+
+  const size_t scenarioCount = sizeof(SCENARIOS) / sizeof(SCENARIOS[0]);
+  Result results[scenarioCount];
+  size_t mismatches = 0;
+  for (size_t i = 0; i < scenarioCount; i++) {
+    std::vector<Sample> samples;
+    generateSynthetic(samples, 21, SCENARIOS[i]);
+    printf("%s=== Dados sintéticos, ruído %s: 21 dias (%zu amostras) ===\n\n",
+           i ? "\n" : "", SCENARIOS[i].name, samples.size());
+    results[i] = run(samples, i == 0);
+    mismatches += results[i].mismatches;
+  }
+
+  printf("\n=== Resumo (partição de %u KB, amostra a cada 2 s) ===\n",
+         STORAGE_BLOCKS * tsdb::BLOCK_SIZE / 1024);
+  printf("%-16s %12s %8s\n", "Ruído", "B/amostra", "Dias");
+  for (size_t i = 0; i < scenarioCount; i++) {
+    printf("%-16s %12.2f %8.1f\n", SCENARIOS[i].name, results[i].bytesPerSample, results[i].days);
+  }
+  return mismatches == 0 ? 0 : 1;
+}
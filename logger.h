@@ -0,0 +1,185 @@
+// Logger assíncrono com níveis (não bloqueia o loop)
+//
+// As mensagens são formatadas num buffer circular pré-alocado e enviadas à
+// Serial depois, por uma task de baixa prioridade (startDrainTask) ou por
+// drain() no tempo ocioso. O envio respeita Serial.availableForWrite(), então
+// nunca espera a UART. Se o buffer estiver cheio, a mensagem é descartada e
+// contada em dropped().
+//
+// Níveis abaixo de LOG_LEVEL são removidos em tempo de compilação (os
+// argumentos nem são avaliados). Defina LOG_LEVEL antes de incluir:
+//   #define LOG_LEVEL LOG_LEVEL_NONE   // Sem log
+// Cada linha sai com o prefixo do nível ("E: ", "W: ", "I: ", "D: ").
+//
+// Um único produtor (a task do loop) e um único consumidor (a task de envio).
+
+#pragma once
+
+#include <stdint.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <Arduino.h>
+#endif
+
+#define LOG_LEVEL_NONE  0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_INFO  3
+#define LOG_LEVEL_DEBUG 4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(...) logger::ring.log('E', __VA_ARGS__)
+#else
+#define LOG_ERROR(...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(...) logger::ring.log('W', __VA_ARGS__)
+#else
+#define LOG_WARN(...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(...) logger::ring.log('I', __VA_ARGS__)
+#else
+#define LOG_INFO(...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) logger::ring.log('D', __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) do {} while (0)
+#endif
+
+namespace logger {
+
+const uint32_t BUFFER_SIZE = 4096;  // Potência de 2
+const uint32_t MAX_MESSAGE = 192;   // Maior mensagem formatada (com \n)
+
+class RingLog {
+public:
+  // Formata e enfileira uma linha com o prefixo do nível (o \n é
+  // acrescentado). Nunca bloqueia.
+  bool log(char level, const char* format, ...) __attribute__((format(printf, 3, 4))) {
+    va_list args;
+    va_start(args, format);
+    bool ok = vlog(level, format, args);
+    va_end(args);
+    return ok;
+  }
+
+  // Formata e enfileira uma linha sem prefixo
+  bool printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+    va_list args;
+    va_start(args, format);
+    bool ok = vlog(0, format, args);
+    va_end(args);
+    return ok;
+  }
+
+  // Envia até budget bytes para out (que deve ter write(const uint8_t*, size_t)).
+  // Retorna o número de bytes enviados.
+  template <typename Writer>
+  uint32_t drain(Writer& out, uint32_t budget) {
+    uint32_t tail = tailPos.load(std::memory_order_relaxed);
+    uint32_t head = headPos.load(std::memory_order_acquire);
+    uint32_t sent = 0;
+    while (head != tail && budget > 0) {
+      uint32_t offset = tail & (BUFFER_SIZE - 1);
+      uint32_t chunk = head - tail;
+      if (chunk > BUFFER_SIZE - offset) chunk = BUFFER_SIZE - offset;  // Até o fim do buffer
+      if (chunk > budget) chunk = budget;
+      out.write(buffer + offset, chunk);
+      tail += chunk;
+      budget -= chunk;
+      sent += chunk;
+    }
+    tailPos.store(tail, std::memory_order_release);
+    return sent;
+  }
+
+  uint32_t pending() const {
+    return headPos.load(std::memory_order_acquire) - tailPos.load(std::memory_order_acquire);
+  }
+  uint32_t dropped() const { return droppedCount.load(std::memory_order_relaxed); }
+  uint32_t messages() const { return messageCount; }
+  uint32_t highWater() const { return maxPending; }
+
+private:
+  bool vlog(char level, const char* format, va_list args) {
+    char line[MAX_MESSAGE];
+    int prefix = 0;
+    if (level) {
+      line[0] = level;
+      line[1] = ':';
+      line[2] = ' ';
+      prefix = 3;
+    }
+    int n = vsnprintf(line + prefix, sizeof(line) - 1 - prefix, format, args);
+    if (n < 0) return false;
+    n += prefix;
+    if (n > (int)sizeof(line) - 2) n = sizeof(line) - 2;
+    line[n++] = '\n';
+    return push((const uint8_t*)line, n);
+  }
+
+  bool push(const uint8_t* data, uint32_t len) {
+    uint32_t head = headPos.load(std::memory_order_relaxed);
+    uint32_t tail = tailPos.load(std::memory_order_acquire);
+    if (BUFFER_SIZE - (head - tail) < len) {
+      droppedCount.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    uint32_t offset = head & (BUFFER_SIZE - 1);
+    uint32_t first = len < BUFFER_SIZE - offset ? len : BUFFER_SIZE - offset;
+    memcpy(buffer + offset, data, first);
+    memcpy(buffer, data + first, len - first);
+    headPos.store(head + len, std::memory_order_release);
+
+    messageCount++;
+    if (head + len - tail > maxPending) maxPending = head + len - tail;
+    return true;
+  }
+
+  uint8_t buffer[BUFFER_SIZE];
+  std::atomic<uint32_t> headPos{0};  // Escrito pelo produtor
+  std::atomic<uint32_t> tailPos{0};  // Escrito pelo consumidor
+  std::atomic<uint32_t> droppedCount{0};
+  uint32_t messageCount = 0;
+  uint32_t maxPending = 0;
+};
+
+// Instância global usada pelas macros LOG_*
+inline RingLog& instance() {
+  static RingLog ring;
+  return ring;
+}
+static RingLog& ring = instance();
+
+#if defined(ARDUINO_ARCH_ESP32)
+// Envia o que couber no buffer de transmissão da Serial, sem esperar
+inline void drain() {
+  int space = Serial.availableForWrite();
+  if (space > 0) ring.drain(Serial, space);
+}
+
+// Task de envio com prioridade 0: só roda quando o loop está ocioso (delay)
+inline void startDrainTask() {
+  xTaskCreatePinnedToCore([](void*) {
+    while (true) {
+      drain();
+      vTaskDelay(1);
+    }
+  }, "logger", 2048, nullptr, 0, nullptr, ARDUINO_RUNNING_CORE);
+}
+#endif
+
+}  // namespace logger
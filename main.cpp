@@ -5,6 +5,19 @@
 #include <Wire.h>
 #include <Adafruit_AHTX0.h>
 #include <BH1750.h>
+#include <time.h>
+#include "timeseries.h"
+#include "alerts.h"
+#include "alert_rules.h"
+#include "agro.h"
+#include "connectivity.h"
+#include "datapath.h"
+#include "trace.h"
+#include "logger.h"
+
+// Gravação de trace das leituras brutas em /trace_NNN.bin (LittleFS, um por boot)
+// 1 = grava (captura de campo para host/trace_replay.cpp), 0 = desativado
+#define TRACE_RECORD 0
 
 // Instâncias dos sensores
 Adafruit_AHTX0 aht;
@@ -36,11 +49,95 @@ int wifiRSSI = 0;               // Nível de sinal WiFi (dBm)
 bool ahtInitialized = false;
 bool bh1750Initialized = false;
 
+// Conversão e publicação das leituras (compartilhado com host/trace_replay.cpp)
+datapath::Pipeline pipeline(SOIL_DRY_VALUE, SOIL_WET_VALUE);
+int lastRssiSample = 0;       // Última leitura bruta de RSSI
+bool rssiSampled = false;     // Nova leitura ainda não processada
+
+// Descartes do logger já informados no Serial
+uint32_t reportedLogDrops = 0;
+
+#if TRACE_RECORD
+trace::TraceRecorder traceRecorder;
+#endif
+
+// Motor de alertas local (regras em alert_rules.h)
+alerts::CompiledRule compiledAlerts[ALERT_RULE_COUNT];
+alerts::RuleState alertState[ALERT_RULE_COUNT];
+alerts::Engine alertEngine(alertRules, compiledAlerts, alertState, ALERT_RULE_COUNT);
+
+// Alertas disparados sem conexão com o Blynk, enviados na reconexão
+alerts::PendingAlert pendingAlerts[ALERT_RULE_COUNT];
+alerts::Outbox alertOutbox(alertRules, pendingAlerts, ALERT_RULE_COUNT);
+
+// Estado de conexão (atualizado por eventos de WiFi e Blynk)
+connectivity::State connection;
+
+// Envia um alerta retido durante a queda de conexão
+void sendPendingAlert(const alerts::Rule& rule, float value, uint8_t occurrences,
+                      uint32_t ageMs) {
+  char description[64];
+  snprintf(description, sizeof(description), "Valor: %.1f (%ux, há %lu s, sem conexão)",
+           value, (unsigned)occurrences, (unsigned long)(ageMs / 1000));
+  Blynk.logEvent(rule.eventCode, description);
+  LOG_INFO("📤 Alerta retido enviado: %s", rule.eventCode);
+}
+
+BLYNK_CONNECTED() {
+  connection.onBlynkConnected();
+  alertOutbox.flush(millis(), sendPendingAlert);
+}
+
+BLYNK_DISCONNECTED() {
+  connection.onBlynkDisconnected();
+}
+
+// Histórico em flash (partição "tsdb" de 768 KB, ver partitions.csv)
+const uint32_t HISTORY_MAX_BLOCKS = 0xC0000 / tsdb::BLOCK_SIZE;
+tsdb::PartitionStorage historyStorage;
+tsdb::BlockIndex historyIndex[HISTORY_MAX_BLOCKS];
+tsdb::Store history(historyStorage, historyIndex, HISTORY_MAX_BLOCKS);
+bool historyInitialized = false;
+
+// Métricas derivadas publicadas em V5 (ponto de orvalho), V6 (VPD) e V7 (DLI)
+agro::Engine agroMetrics;
+const long LOCAL_UTC_OFFSET = -3 * 3600;  // Fuso local (s): o DLI zera à meia-noite
+
+// Dia local para o DLI. Retorna false enquanto o relógio não sincroniza:
+// sem hora válida não há meia-noite, então o DLI não é integrado nem publicado.
+bool localDay(uint32_t& day) {
+  time_t now = time(nullptr);
+  if (now <= 1600000000) return false;
+  day = (uint32_t)((now + LOCAL_UTC_OFFSET) / 86400);
+  return true;
+}
+
+// Envia o alerta imediatamente (evento Blynk) e registra no Serial. Sem
+// conexão, o alerta fica retido até BLYNK_CONNECTED().
+void onAlert(const alerts::Rule& rule, bool active, float value, void* ctx) {
+  if (active) {
+    LOG_WARN("🚨 Alerta: %s (valor: %.1f)", rule.eventCode, value);
+  } else {
+    LOG_INFO("✓ Normalizado: %s (valor: %.1f)", rule.eventCode, value);
+  }
+  
+  if (!active) return;
+  if (connection.blynkConnected()) {
+    Blynk.logEvent(rule.eventCode, String("Valor: ") + String(value, 1));
+  } else {
+    alertOutbox.hold(rule, value, millis());
+  }
+}
+
 void setup() {
   // Inicializa Serial Monitor
   Serial.begin(115200);
   delay(1000);
   
+  // Task de envio do log: o loop só enfileira mensagens. Inicia antes de
+  // qualquer retorno antecipado do setup (ex.: WiFi indisponível).
+  logger::startDrainTask();
+  
   Serial.println("\n=== Sistema de Monitoramento ESP32 ===");
   
   // Inicializa I2C (pinos padrão ESP32: SDA=21, SCL=22)
@@ -73,16 +170,54 @@ void setup() {
     Serial.println("  Verifique a conexão I2C (SDA=GPIO21, SCL=GPIO22)");
   }
   
+  // Compila as regras de alerta
+  alertEngine.begin();
+  
+  // Tabela de pressão de saturação das métricas derivadas
+  agroMetrics.begin();
+  
+#if TRACE_RECORD
+  // Inicia a gravação do trace
+  trace::Header traceHeader = {trace::TRACE_VERSION, trace::TRACE_HAS_OUTPUTS,
+                               SOIL_DRY_VALUE, SOIL_WET_VALUE, sensorReadInterval};
+  if (traceRecorder.begin(traceHeader)) {
+    Serial.print("\n✓ Gravando trace em ");
+    Serial.println(traceRecorder.path());
+  } else {
+    Serial.println("\n✗ Falha ao iniciar o trace (LittleFS)");
+  }
+#endif
+  
+  // Inicializa histórico em flash
+  Serial.println("\nInicializando histórico em flash...");
+  if (historyStorage.begin() && history.begin()) {
+    Serial.print("✓ Histórico pronto: ");
+    Serial.print(history.sealedBlocks());
+    Serial.print(" de ");
+    Serial.print(history.blockCapacity());
+    Serial.println(" blocos usados");
+    historyInitialized = true;
+  } else {
+    Serial.println("✗ Partição 'tsdb' não encontrada!");
+    Serial.println("  Grave com a tabela partitions.csv (ver README.md)");
+  }
+  
   // Conecta ao WiFi
   Serial.println("\nConectando ao WiFi...");
   Serial.print("SSID: ");
   Serial.println(WIFI_SSID);
   
+  connection.attachWifiEvents();
   WiFi.mode(WIFI_STA);
   WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
   
+  // Sincroniza relógio (UTC) para o histórico e o DLI. O SNTP continua
+  // tentando em segundo plano, então a hora chega mesmo se o WiFi só
+  // conectar depois do setup.
+  configTime(0, 0, "pool.ntp.org");
+  
   int wifiAttempts = 0;
-  while (WiFi.status() != WL_CONNECTED && wifiAttempts < 20) {
+  while (!connection.wifiConnected() && wifiAttempts < 20) {
     delay(500);
     Serial.print(".");
     wifiAttempts++;
@@ -91,7 +226,7 @@ void setup() {
   Serial.println();
   
   // Verifica conexão WiFi
-  if (WiFi.status() == WL_CONNECTED) {
+  if (connection.wifiConnected()) {
     Serial.println("✓ WiFi conectado com sucesso!");
     Serial.print("IP Address: ");
     Serial.println(WiFi.localIP());
@@ -119,7 +254,7 @@ void setup() {
   unsigned long blynkStartTime = millis();
   const unsigned long blynkTimeout = 30000; // 30 segundos
   
-  while (!Blynk.connected() && blynkAttempts < 60) {
+  while (!connection.blynkConnected() && blynkAttempts < 60) {
     Blynk.run();
     
     // Verifica timeout
@@ -142,7 +277,7 @@ void setup() {
   
   Serial.println();
   
-  if (Blynk.connected()) {
+  if (connection.blynkConnected()) {
     Serial.println("✓ Blynk conectado com sucesso!");
     Serial.print("Tempo de conexão: ");
     Serial.print((millis() - blynkStartTime) / 1000.0);
@@ -154,6 +289,9 @@ void setup() {
     Serial.println("  V2 - Luminosidade (lux)");
     Serial.println("  V3 - Umidade do Solo (%)");
     Serial.println("  V4 - Sinal WiFi (dBm)");
+    Serial.println("  V5 - Ponto de Orvalho (°C)");
+    Serial.println("  V6 - Déficit de Pressão de Vapor (kPa)");
+    Serial.println("  V7 - Integral de Luz Diária (mol/m²/dia)");
   } else {
     Serial.println("✗ Falha na conexão Blynk!");
     Serial.println("O sistema continuará funcionando, mas sem envio para Blynk.");
@@ -168,114 +306,152 @@ void setup() {
 
 void loop() {
   // Mantém conexões ativas
-  if (WiFi.status() != WL_CONNECTED) {
-    Serial.println("WiFi desconectado! Tentando reconectar...");
+  if (!connection.wifiConnected()) {
+    LOG_WARN("WiFi desconectado! Tentando reconectar...");
     WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
     delay(2000);
   }
   
   Blynk.run();
   
+  // Amostra o RSSI em agenda própria (suavizado no datapath)
+  if (connection.wifiConnected() && connection.rssiDue(millis())) {
+    lastRssiSample = WiFi.RSSI();
+    rssiSampled = true;
+    connection.markRssiSampled(millis());
+  }
+  
   // Lê sensores a cada 2 segundos
   if (millis() - lastSensorRead >= sensorReadInterval) {
     lastSensorRead = millis();
     
+    // Leituras brutas do ciclo (entrada do datapath e do trace)
+    datapath::RawSample raw = {};
+    raw.timestampMs = lastSensorRead;
+    
     // Lê sensor AHT20/AHT21 (Temperatura e Umidade)
-    if (ahtInitialized) {
-      sensors_event_t humid, temp;
-      aht.getEvent(&humid, &temp);
-      
-      temperature = temp.temperature;
-      humidity = humid.relative_humidity;
-      
-      // Envia para Blynk
-      if (Blynk.connected()) {
-        Blynk.virtualWrite(V0, temperature);
-        Blynk.virtualWrite(V1, humidity);
-      }
+    if (ahtInitialized && datapath::readAhtRaw(Wire, raw.aht)) {
+      raw.flags |= datapath::AHT_OK;
     }
     
     // Lê sensor BH1750 (Luminosidade)
-    if (bh1750Initialized) {
-      lightLevel = lightMeter.readLightLevel();
-      
-      // Envia para Blynk
-      if (Blynk.connected()) {
-        Blynk.virtualWrite(V2, lightLevel);
-      }
+    if (bh1750Initialized && datapath::readBh1750Raw(Wire, raw.bh1750)) {
+      raw.flags |= datapath::BH1750_OK;
     }
     
     // Lê Sensor de Umidade do Solo Capacitivo (Analógico)
     soilMoistureRaw = analogRead(SOIL_MOISTURE_PIN);
+    raw.soilAdc = soilMoistureRaw;
+    
+    // Nível de Sinal WiFi (amostrado em agenda própria)
+    if (rssiSampled) {
+      raw.rssi = lastRssiSample;
+      raw.flags |= datapath::RSSI_SAMPLED;
+      rssiSampled = false;
+    }
+    if (connection.wifiConnected()) raw.flags |= datapath::WIFI_UP;
+    if (connection.blynkConnected()) raw.flags |= datapath::BLYNK_UP;
     
-    // Converte para porcentagem (0% = seco, 100% = molhado)
-    // Inverte a leitura porque valores maiores = mais seco
-    soilMoisturePercent = map(soilMoistureRaw, SOIL_DRY_VALUE, SOIL_WET_VALUE, 0, 100);
+    // Converte, limita e decide o que publicar
+    datapath::Published published;
+    pipeline.process(raw, published);
+    temperature = pipeline.temperature;
+    humidity = pipeline.humidity;
+    lightLevel = pipeline.lightLevel;
+    soilMoisturePercent = pipeline.soilMoisturePercent;
+    wifiRSSI = pipeline.wifiRSSI;
     
-    // Limita entre 0 e 100%
-    if (soilMoisturePercent < 0) soilMoisturePercent = 0;
-    if (soilMoisturePercent > 100) soilMoisturePercent = 100;
+    // Envia para Blynk (bit n da máscara = Vn)
+    if (published.mask & 0x01) Blynk.virtualWrite(V0, temperature);
+    if (published.mask & 0x02) Blynk.virtualWrite(V1, humidity);
+    if (published.mask & 0x04) Blynk.virtualWrite(V2, lightLevel);
+    if (published.mask & 0x08) Blynk.virtualWrite(V3, soilMoisturePercent);
+    if (published.mask & 0x10) Blynk.virtualWrite(V4, wifiRSSI);
     
-    // Envia para Blynk
-    if (Blynk.connected()) {
-      Blynk.virtualWrite(V3, soilMoisturePercent);
+    // Métricas derivadas, publicadas junto com as leituras de origem
+    if (raw.flags & datapath::AHT_OK) {
+      agroMetrics.updateClimate(temperature, humidity);
     }
+    uint32_t day;
+    bool clockValid = localDay(day);
+    if ((raw.flags & datapath::BH1750_OK) && clockValid) {
+      agroMetrics.updateLight(lastSensorRead, day, lightLevel);
+    }
+    if (published.mask & 0x01) {
+      Blynk.virtualWrite(V5, agroMetrics.dewPoint);
+      Blynk.virtualWrite(V6, agroMetrics.vpd);
+    }
+    if ((published.mask & 0x04) && clockValid) Blynk.virtualWrite(V7, agroMetrics.dli);
     
-    // Lê Nível de Sinal WiFi (RSSI)
-    if (WiFi.status() == WL_CONNECTED) {
-      wifiRSSI = WiFi.RSSI();
-      
-      // Envia para Blynk
-      if (Blynk.connected()) {
-        Blynk.virtualWrite(V4, wifiRSSI);
-      }
+#if TRACE_RECORD
+    traceRecorder.record(raw, published);
+#endif
+    
+    float values[tsdb::CHANNEL_COUNT] = {
+      temperature, humidity, lightLevel, soilMoisturePercent, (float)wifiRSSI
+    };
+    
+    // Canais lidos neste ciclo: regras de sensores com falha não são avaliadas
+    uint8_t validChannels = 1 << tsdb::CH_SOIL;
+    if (raw.flags & datapath::AHT_OK) {
+      validChannels |= (1 << tsdb::CH_TEMPERATURE) | (1 << tsdb::CH_HUMIDITY);
+    }
+    if (raw.flags & datapath::BH1750_OK) validChannels |= 1 << tsdb::CH_LIGHT;
+    if (raw.flags & datapath::WIFI_UP) validChannels |= 1 << tsdb::CH_RSSI;
+    
+    // Avalia alertas locais logo após a leitura
+    alertEngine.evaluate(millis(), values, validChannels, onAlert, nullptr);
+    
+    // Grava no histórico em flash (somente com relógio sincronizado)
+    time_t now = time(nullptr);
+    if (historyInitialized && now > 1600000000) {
+      history.append((uint32_t)now, values);
     }
     
     // Exibe no Serial Monitor (mesma frequência do Blynk - 2 segundos)
-    Serial.println("\n--- Leituras dos Sensores ---");
+    // Enfileirado no logger: o envio pela UART fica com a task de baixa prioridade
+    LOG_INFO("--- Leituras dos Sensores ---");
     
     if (ahtInitialized) {
-      Serial.print("🌡️  Temperatura: ");
-      Serial.print(temperature, 1);
-      Serial.println(" °C");
-      
-      Serial.print("💧 Umidade Ar: ");
-      Serial.print(humidity, 1);
-      Serial.println(" %");
+      LOG_INFO("🌡️  Temperatura: %.1f °C", temperature);
+      LOG_INFO("💧 Umidade Ar: %.1f %%", humidity);
+      LOG_INFO("🌫️  Ponto de Orvalho: %.1f °C | VPD: %.2f kPa", agroMetrics.dewPoint, agroMetrics.vpd);
     }
     
     if (bh1750Initialized) {
-      Serial.print("☀️  Luminosidade: ");
-      Serial.print(lightLevel, 0);
-      Serial.println(" lux");
+      if (clockValid) {
+        LOG_INFO("☀️  Luminosidade: %.0f lux | DLI: %.2f mol/m²/dia", lightLevel, agroMetrics.dli);
+      } else {
+        LOG_INFO("☀️  Luminosidade: %.0f lux | DLI: aguardando NTP", lightLevel);
+      }
     }
     
-    Serial.print("🌱 Umidade Solo: ");
-    Serial.print(soilMoisturePercent, 0);
-    Serial.print(" % (ADC: ");
-    Serial.print(soilMoistureRaw);
-    Serial.println(")");
+    LOG_INFO("🌱 Umidade Solo: %.0f %% (ADC: %d)", soilMoisturePercent, soilMoistureRaw);
       
     // Exibe nível de sinal WiFi
-    if (WiFi.status() == WL_CONNECTED) {
-      Serial.print("📶 Sinal WiFi: ");
-      Serial.print(wifiRSSI);
-      Serial.print(" dBm");
-      
+    if (connection.wifiConnected()) {
       // Indicador de qualidade do sinal
+      const char* quality;
       if (wifiRSSI > -50) {
-        Serial.println(" (Excelente)");
+        quality = "Excelente";
       } else if (wifiRSSI > -60) {
-        Serial.println(" (Muito Bom)");
+        quality = "Muito Bom";
       } else if (wifiRSSI > -70) {
-        Serial.println(" (Bom)");
+        quality = "Bom";
       } else if (wifiRSSI > -80) {
-        Serial.println(" (Fraco)");
+        quality = "Fraco";
       } else {
-        Serial.println(" (Muito Fraco)");
+        quality = "Muito Fraco";
       }
+      LOG_INFO("📶 Sinal WiFi: %d dBm (%s)", wifiRSSI, quality);
     } else {
-      Serial.println("📶 Sinal WiFi: Desconectado");
+      LOG_INFO("📶 Sinal WiFi: Desconectado");
+    }
+    
+    // Mensagens de log descartadas (buffer cheio ou Serial sem vazão)
+    if (logger::ring.dropped() != reportedLogDrops) {
+      reportedLogDrops = logger::ring.dropped();
+      LOG_WARN("⚠ Log: %u mensagens descartadas", (unsigned)reportedLogDrops);
     }
   }
   
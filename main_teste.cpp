@@ -5,6 +5,15 @@
 #include <Wire.h>
 #include <Adafruit_AHTX0.h>
 #include <BH1750.h>
+#include "alerts.h"
+#include "alert_rules.h"
+#include "agro.h"
+#include "connectivity.h"
+
+// Nível do logger assíncrono (definido antes de incluir logger.h). Compare o
+// tempo de ciclo com LOG_LEVEL_NONE para medir o custo do log na leitura.
+#define LOG_LEVEL LOG_LEVEL_INFO
+#include "logger.h"
 
 // ======================== CONFIGURAÇÃO DE TESTE ========================
 #define TEST_MODE true              // Modo de teste ativado
@@ -38,6 +47,39 @@ int wifiRSSI = 0;               // Nível de sinal WiFi (dBm)
 bool ahtInitialized = false;
 bool bh1750Initialized = false;
 
+// Motor de alertas local (mesmas regras de main.cpp, em alert_rules.h)
+alerts::CompiledRule compiledAlerts[ALERT_RULE_COUNT];
+alerts::RuleState alertState[ALERT_RULE_COUNT];
+alerts::Engine alertEngine(alertRules, compiledAlerts, alertState, ALERT_RULE_COUNT);
+
+// Alertas disparados sem conexão com o Blynk, enviados na reconexão
+alerts::PendingAlert pendingAlerts[ALERT_RULE_COUNT];
+alerts::Outbox alertOutbox(alertRules, pendingAlerts, ALERT_RULE_COUNT);
+
+// Estado de conexão (atualizado por eventos de WiFi e Blynk)
+connectivity::State connection;
+connectivity::Counters linkSeen = {};  // Transições já registradas pelo loop
+connectivity::RssiFilter rssiFilter;  // RSSI suavizado publicado em V4
+
+// Envia um alerta retido durante a queda de conexão
+void sendPendingAlert(const alerts::Rule& rule, float value, uint8_t occurrences,
+                      uint32_t ageMs) {
+  char description[64];
+  snprintf(description, sizeof(description), "Valor: %.1f (%ux, há %lu s, sem conexão)",
+           value, (unsigned)occurrences, (unsigned long)(ageMs / 1000));
+  Blynk.logEvent(rule.eventCode, description);
+  LOG_INFO("📤 Alerta retido enviado: %s (%lu s)", rule.eventCode, (unsigned long)(ageMs / 1000));
+}
+
+BLYNK_CONNECTED() {
+  connection.onBlynkConnected();
+  alertOutbox.flush(millis(), sendPendingAlert);
+}
+
+BLYNK_DISCONNECTED() {
+  connection.onBlynkDisconnected();
+}
+
 // ======================== MÉTRICAS DE TESTE ========================
 struct TestMetrics {
   // Contadores
@@ -74,6 +116,39 @@ struct TestMetrics {
   unsigned long maxBlynkLatency = 0;
   unsigned long totalBlynkLatency = 0;
   
+  // Alertas locais
+  unsigned long alertEvalCount = 0;
+  unsigned long totalAlertEvalTime = 0;   // μs
+  unsigned long maxAlertEvalTime = 0;     // μs
+  unsigned long alertsRaised = 0;
+  unsigned long alertsCleared = 0;
+  unsigned long alertsDeferred = 0;       // Retidos sem conexão (enviados na reconexão)
+  
+  // Métricas derivadas (ponto de orvalho, VPD e DLI)
+  // Ciclos de CPU: tabela (agro.h) x mesmo cálculo com expf/logf
+  unsigned long agroEvalCount = 0;
+  uint64_t totalAgroCycles = 0;
+  uint32_t maxAgroCycles = 0;
+  uint64_t totalReferenceCycles = 0;
+  uint32_t maxReferenceCycles = 0;
+  
+  // Ciclo completo de leitura, incluindo alertas, envio e log (μs)
+  unsigned long cycleCount = 0;
+  unsigned long minCycleTime = 999999;
+  unsigned long maxCycleTime = 0;
+  unsigned long totalCycleTime = 0;
+  
+  // Latência amostra → alerta (μs)
+  unsigned long minAlertLatency = 999999;
+  unsigned long maxAlertLatency = 0;
+  unsigned long totalAlertLatency = 0;
+  
+  // Custo das consultas de conexão (ciclos de CPU, ESP.getCycleCount())
+  unsigned long linkQueryCount = 0;
+  uint64_t totalPollCycles = 0;           // WiFi.status() + Blynk.connected()
+  uint64_t totalCachedCycles = 0;         // connection.wifiConnected() + connection.blynkConnected()
+  unsigned long linkMismatches = 0;       // Cache diferente do polling no mesmo instante
+  
   // Memória
   unsigned long minFreeHeap = 999999;
   unsigned long maxFreeHeap = 0;
@@ -84,12 +159,46 @@ struct TestMetrics {
 
 TestMetrics metrics;
 
-// Flags de estado anterior
-bool wasWifiConnected = false;
-bool wasBlynkConnected = false;
+// Métricas derivadas (V5 ponto de orvalho, V6 VPD, V7 DLI)
+agro::Engine agroMetrics;
+float referenceDewPoint = 0.0;  // Resultado da versão expf/logf (evita descartar o cálculo)
+float referenceVpd = 0.0;
+
+// Ponto de orvalho e VPD com expf/logf, apenas para comparar o custo
+void referenceClimate(float t, float rh) {
+  float g = 17.27f * t / (t + 237.3f);
+  float sat = 0.6108f * expf(g);
+  referenceVpd = sat * (1.0f - rh * 0.01f);
+  g += logf(rh * 0.01f);
+  referenceDewPoint = 237.3f * g / (17.27f - g);
+}
 
 // ======================== FUNÇÕES DE TESTE ========================
 
+// Envia o alerta e mede a latência desde o início da leitura (ctx)
+void onAlert(const alerts::Rule& rule, bool active, float value, void* ctx) {
+  if (!active) {
+    metrics.alertsCleared++;
+    LOG_INFO("✓ Alerta normalizado: %s", rule.eventCode);
+    return;
+  }
+  
+  if (connection.blynkConnected()) {
+    Blynk.logEvent(rule.eventCode, String("Valor: ") + String(value, 1));
+  } else {
+    alertOutbox.hold(rule, value, millis());
+    metrics.alertsDeferred++;
+  }
+  
+  unsigned long latency = micros() - *(unsigned long*)ctx;
+  metrics.alertsRaised++;
+  metrics.totalAlertLatency += latency;
+  if (latency < metrics.minAlertLatency) metrics.minAlertLatency = latency;
+  if (latency > metrics.maxAlertLatency) metrics.maxAlertLatency = latency;
+  
+  LOG_WARN("🚨 Alerta: %s (valor: %.1f)", rule.eventCode, value);
+}
+
 void printTestHeader() {
   Serial.println("\n╔════════════════════════════════════════════════════════════╗");
   Serial.println("║          SISTEMA DE TESTES - SENSORES ESP32               ║");
@@ -195,6 +304,93 @@ void printMetrics() {
     Serial.println(" μs");
   }
   
+  Serial.println("╠════════════════════════════════════════════════════════════╣");
+  Serial.println("║                  ALERTAS LOCAIS                            ║");
+  Serial.println("╠════════════════════════════════════════════════════════════╣");
+  
+  Serial.print("║ Alertas disparados: ");
+  Serial.println(metrics.alertsRaised);
+  Serial.print("║ Alertas normalizados: ");
+  Serial.println(metrics.alertsCleared);
+  Serial.print("║ Retidos sem conexão: ");
+  Serial.print(metrics.alertsDeferred);
+  Serial.print(" (pendentes: ");
+  Serial.print(alertOutbox.pendingCount());
+  Serial.println(")");
+  
+  if (metrics.alertEvalCount > 0) {
+    Serial.print("║ Avaliação média: ");
+    Serial.print(metrics.totalAlertEvalTime / metrics.alertEvalCount);
+    Serial.println(" μs");
+    Serial.print("║ Avaliação máxima: ");
+    Serial.print(metrics.maxAlertEvalTime);
+    Serial.println(" μs");
+  }
+  
+  if (metrics.alertsRaised > 0) {
+    Serial.print("║ Latência amostra→alerta (min/méd/máx): ");
+    Serial.print(metrics.minAlertLatency);
+    Serial.print(" / ");
+    Serial.print(metrics.totalAlertLatency / metrics.alertsRaised);
+    Serial.print(" / ");
+    Serial.print(metrics.maxAlertLatency);
+    Serial.println(" μs");
+  }
+  
+  Serial.println("╠════════════════════════════════════════════════════════════╣");
+  Serial.println("║              MÉTRICAS DERIVADAS                            ║");
+  Serial.println("╠════════════════════════════════════════════════════════════╣");
+  
+  Serial.print("║ Ponto de orvalho: ");
+  Serial.print(agroMetrics.dewPoint, 1);
+  Serial.println(" °C");
+  Serial.print("║ VPD: ");
+  Serial.print(agroMetrics.vpd, 2);
+  Serial.println(" kPa");
+  Serial.print("║ DLI (dia de uptime, zera a cada 24 h): ");
+  Serial.print(agroMetrics.dli, 2);
+  Serial.println(" mol/m²");
+  if (metrics.agroEvalCount > 0) {
+    Serial.print("║ Tabela (méd/máx): ");
+    Serial.print((unsigned long)(metrics.totalAgroCycles / metrics.agroEvalCount));
+    Serial.print(" / ");
+    Serial.print(metrics.maxAgroCycles);
+    Serial.println(" ciclos");
+    Serial.print("║ expf/logf (méd/máx): ");
+    Serial.print((unsigned long)(metrics.totalReferenceCycles / metrics.agroEvalCount));
+    Serial.print(" / ");
+    Serial.print(metrics.maxReferenceCycles);
+    Serial.println(" ciclos");
+    Serial.print("║ Diferença (orvalho / VPD): ");
+    Serial.print(agroMetrics.dewPoint - referenceDewPoint, 3);
+    Serial.print(" °C / ");
+    Serial.print(agroMetrics.vpd - referenceVpd, 4);
+    Serial.println(" kPa");
+  }
+  
+  Serial.println("╠════════════════════════════════════════════════════════════╣");
+  Serial.println("║              CICLO DE LEITURA E LOG                        ║");
+  Serial.println("╠════════════════════════════════════════════════════════════╣");
+  
+  if (metrics.cycleCount > 0) {
+    Serial.print("║ Ciclo (min/méd/máx): ");
+    Serial.print(metrics.minCycleTime);
+    Serial.print(" / ");
+    Serial.print(metrics.totalCycleTime / metrics.cycleCount);
+    Serial.print(" / ");
+    Serial.print(metrics.maxCycleTime);
+    Serial.println(" μs");
+  }
+  Serial.print("║ Mensagens de log: ");
+  Serial.println(logger::ring.messages());
+  Serial.print("║ Mensagens descartadas: ");
+  Serial.println(logger::ring.dropped());
+  Serial.print("║ Pico do buffer de log: ");
+  Serial.print(logger::ring.highWater());
+  Serial.print(" de ");
+  Serial.print(logger::BUFFER_SIZE);
+  Serial.println(" bytes");
+  
   Serial.println("╠════════════════════════════════════════════════════════════╣");
   Serial.println("║              ESTABILIDADE DE CONEXÃO                       ║");
   Serial.println("╠════════════════════════════════════════════════════════════╣");
@@ -208,6 +404,23 @@ void printMetrics() {
   Serial.print("║ Blynk reconexões: ");
   Serial.println(metrics.blynkReconnects);
   
+  Serial.println("╠════════════════════════════════════════════════════════════╣");
+  Serial.println("║          CUSTO DAS CONSULTAS DE CONEXÃO                    ║");
+  Serial.println("╠════════════════════════════════════════════════════════════╣");
+  
+  if (metrics.linkQueryCount > 0) {
+    Serial.print("║ Polling (status + connected): ");
+    Serial.print((unsigned long)(metrics.totalPollCycles / metrics.linkQueryCount));
+    Serial.println(" ciclos");
+    Serial.print("║ Cache (eventos): ");
+    Serial.print((unsigned long)(metrics.totalCachedCycles / metrics.linkQueryCount));
+    Serial.println(" ciclos");
+  }
+  Serial.print("║ Cache diferente do polling: ");
+  Serial.print(metrics.linkMismatches);
+  Serial.print(" de ");
+  Serial.println(metrics.linkQueryCount);
+  
   Serial.println("╠════════════════════════════════════════════════════════════╣");
   Serial.println("║                 CONSUMO DE MEMÓRIA                         ║");
   Serial.println("╠════════════════════════════════════════════════════════════╣");
@@ -266,6 +479,41 @@ void printFinalReport() {
   Serial.print("WiFi Reconexões,"); Serial.println(metrics.wifiReconnects);
   Serial.print("Blynk Desconexões,"); Serial.println(metrics.blynkDisconnects);
   Serial.print("Blynk Reconexões,"); Serial.println(metrics.blynkReconnects);
+  Serial.print("Alertas Disparados,"); Serial.println(metrics.alertsRaised);
+  Serial.print("Alertas Normalizados,"); Serial.println(metrics.alertsCleared);
+  Serial.print("Alertas Retidos,"); Serial.println(metrics.alertsDeferred);
+  if (metrics.alertEvalCount > 0) {
+    Serial.print("Avaliação Alertas Média (μs),");
+    Serial.println(metrics.totalAlertEvalTime / metrics.alertEvalCount);
+  }
+  Serial.print("Avaliação Alertas Max (μs),"); Serial.println(metrics.maxAlertEvalTime);
+  if (metrics.alertsRaised > 0) {
+    Serial.print("Latência Alerta Média (μs),");
+    Serial.println(metrics.totalAlertLatency / metrics.alertsRaised);
+  }
+  Serial.print("Latência Alerta Max (μs),"); Serial.println(metrics.maxAlertLatency);
+  if (metrics.agroEvalCount > 0) {
+    Serial.print("Métricas Derivadas Tabela Média (ciclos),");
+    Serial.println((unsigned long)(metrics.totalAgroCycles / metrics.agroEvalCount));
+    Serial.print("Métricas Derivadas expf/logf Média (ciclos),");
+    Serial.println((unsigned long)(metrics.totalReferenceCycles / metrics.agroEvalCount));
+  }
+  Serial.print("Métricas Derivadas Tabela Max (ciclos),"); Serial.println(metrics.maxAgroCycles);
+  Serial.print("Métricas Derivadas expf/logf Max (ciclos),"); Serial.println(metrics.maxReferenceCycles);
+  if (metrics.cycleCount > 0) {
+    Serial.print("Ciclo Médio (μs),");
+    Serial.println(metrics.totalCycleTime / metrics.cycleCount);
+  }
+  Serial.print("Ciclo Max (μs),"); Serial.println(metrics.maxCycleTime);
+  Serial.print("Log Mensagens,"); Serial.println(logger::ring.messages());
+  Serial.print("Log Descartadas,"); Serial.println(logger::ring.dropped());
+  if (metrics.linkQueryCount > 0) {
+    Serial.print("Consulta Polling (ciclos),");
+    Serial.println((unsigned long)(metrics.totalPollCycles / metrics.linkQueryCount));
+    Serial.print("Consulta Cache (ciclos),");
+    Serial.println((unsigned long)(metrics.totalCachedCycles / metrics.linkQueryCount));
+  }
+  Serial.print("Cache x Polling Divergências,"); Serial.println(metrics.linkMismatches);
   Serial.print("Heap Min (bytes),"); Serial.println(metrics.minFreeHeap);
   Serial.print("Heap Max (bytes),"); Serial.println(metrics.maxFreeHeap);
   Serial.println();
@@ -282,6 +530,12 @@ void setup() {
   // Inicializa I2C
   Wire.begin();
   
+  // Compila as regras de alerta
+  alertEngine.begin();
+  
+  // Tabela de pressão de saturação das métricas derivadas
+  agroMetrics.begin();
+  
   // Configura pino ADC do sensor de umidade do solo
   pinMode(SOIL_MOISTURE_PIN, INPUT);
   Serial.println("✓ Sensor de umidade do solo configurado");
@@ -306,24 +560,24 @@ void setup() {
   
   // Conecta ao WiFi
   Serial.print("Conectando ao WiFi... ");
+  connection.attachWifiEvents();
   WiFi.mode(WIFI_STA);
   WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
   
   int wifiAttempts = 0;
-  while (WiFi.status() != WL_CONNECTED && wifiAttempts < 20) {
+  while (!connection.wifiConnected() && wifiAttempts < 20) {
     delay(500);
     Serial.print(".");
     wifiAttempts++;
   }
   
-  if (WiFi.status() == WL_CONNECTED) {
+  if (connection.wifiConnected()) {
     Serial.println(" ✓ OK");
     Serial.print("IP: ");
     Serial.println(WiFi.localIP());
     Serial.print("RSSI inicial: ");
     Serial.print(WiFi.RSSI());
     Serial.println(" dBm");
-    wasWifiConnected = true;
   } else {
     Serial.println(" ✗ FALHA");
   }
@@ -336,7 +590,7 @@ void setup() {
   unsigned long blynkStartTime = millis();
   const unsigned long blynkTimeout = 30000; // 30 segundos
   
-  while (!Blynk.connected() && blynkAttempts < 60) {
+  while (!connection.blynkConnected() && blynkAttempts < 60) {
     Blynk.run();
     
     // Verifica timeout
@@ -357,13 +611,12 @@ void setup() {
     }
   }
   
-  if (Blynk.connected()) {
+  if (connection.blynkConnected()) {
     Serial.println(" ✓ OK");
     Serial.print("Tempo de conexão: ");
     Serial.print((millis() - blynkStartTime) / 1000.0);
     Serial.println("s");
-    Serial.println("Virtual Pins: V0-V4 (Temp, Umid, Luz, Solo, WiFi)");
-    wasBlynkConnected = true;
+    Serial.println("Virtual Pins: V0-V7 (Temp, Umid, Luz, Solo, WiFi, Orvalho, VPD, DLI)");
   } else {
     Serial.println(" ✗ FALHA - Continuando sem Blynk");
   }
@@ -383,45 +636,53 @@ void loop() {
     while(1) { delay(1000); } // Para o sistema
   }
   
-  // Monitora conexões
-  bool currentWifiStatus = (WiFi.status() == WL_CONNECTED);
-  bool currentBlynkStatus = Blynk.connected();
-  
-  if (wasWifiConnected && !currentWifiStatus) {
-    metrics.wifiDisconnects++;
-    Serial.println("⚠ WiFi desconectado!");
-  }
-  if (!wasWifiConnected && currentWifiStatus) {
-    metrics.wifiReconnects++;
-    Serial.println("✓ WiFi reconectado!");
-  }
-  
-  if (wasBlynkConnected && !currentBlynkStatus) {
-    metrics.blynkDisconnects++;
-    Serial.println("⚠ Blynk desconectado!");
-  }
-  if (!wasBlynkConnected && currentBlynkStatus) {
-    metrics.blynkReconnects++;
-    Serial.println("✓ Blynk reconectado!");
-  }
-  
-  wasWifiConnected = currentWifiStatus;
-  wasBlynkConnected = currentBlynkStatus;
+  // Monitora conexões (transições contadas pelos eventos, inclusive quedas
+  // mais curtas que um ciclo do loop; simulado em host/connectivity_sim.cpp)
+  connectivity::Counters changes = connectivity::pollChanges(connection, linkSeen);
+  for (uint32_t i = 0; i < changes.wifiDisconnects; i++) LOG_WARN("⚠ WiFi desconectado!");
+  for (uint32_t i = 0; i < changes.wifiReconnects; i++) LOG_INFO("✓ WiFi reconectado!");
+  for (uint32_t i = 0; i < changes.blynkDisconnects; i++) LOG_WARN("⚠ Blynk desconectado!");
+  for (uint32_t i = 0; i < changes.blynkReconnects; i++) LOG_INFO("✓ Blynk reconectado!");
+  metrics.wifiDisconnects = linkSeen.wifiDisconnects;
+  metrics.wifiReconnects = linkSeen.wifiReconnects;
+  metrics.blynkDisconnects = linkSeen.blynkDisconnects;
+  metrics.blynkReconnects = linkSeen.blynkReconnects;
+  
+  // Mede as consultas de conexão: polling (loop antigo) x estado em cache
+  uint32_t pollStart = ESP.getCycleCount();
+  bool polledWifi = WiFi.status() == WL_CONNECTED;
+  bool polledBlynk = Blynk.connected();
+  uint32_t cachedStart = ESP.getCycleCount();
+  bool cachedWifi = connection.wifiConnected();
+  bool cachedBlynk = connection.blynkConnected();
+  uint32_t cachedEnd = ESP.getCycleCount();
+  metrics.linkQueryCount++;
+  metrics.totalPollCycles += cachedStart - pollStart;
+  metrics.totalCachedCycles += cachedEnd - cachedStart;
+  if (polledWifi != cachedWifi || polledBlynk != cachedBlynk) metrics.linkMismatches++;
   
   // Tenta reconectar WiFi se necessário
-  if (!currentWifiStatus) {
+  if (!connection.wifiConnected()) {
     WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
     delay(100);
   }
   
   Blynk.run();
   
+  // Amostra o RSSI em agenda própria (valor suavizado)
+  if (connection.wifiConnected() && connection.rssiDue(currentTime)) {
+    rssiFilter.update(WiFi.RSSI());
+    connection.markRssiSampled(currentTime);
+    metrics.wifiReadCount++;
+  }
+  
   // Lê sensores a cada 2 segundos
   if (currentTime - lastSensorRead >= sensorReadInterval) {
     lastSensorRead = currentTime;
     
     unsigned long readStartTime = micros();
     bool readSuccess = true;
+    uint8_t validChannels = 1 << tsdb::CH_SOIL;  // Canais lidos neste ciclo
     
     metrics.totalReadings++;
     
@@ -431,6 +692,7 @@ void loop() {
       if (aht.getEvent(&humid, &temp)) {
         temperature = temp.temperature;
         humidity = humid.relative_humidity;
+        validChannels |= (1 << tsdb::CH_TEMPERATURE) | (1 << tsdb::CH_HUMIDITY);
         metrics.ahtReadCount++;
       } else {
         metrics.ahtFailCount++;
@@ -443,6 +705,7 @@ void loop() {
       float reading = lightMeter.readLightLevel();
       if (reading >= 0) {
         lightLevel = reading;
+        validChannels |= 1 << tsdb::CH_LIGHT;
         metrics.bh1750ReadCount++;
       } else {
         metrics.bh1750FailCount++;
@@ -457,10 +720,10 @@ void loop() {
     if (soilMoisturePercent > 100) soilMoisturePercent = 100;
     metrics.soilReadCount++;
     
-    // Lê Nível de Sinal WiFi (RSSI)
-    if (WiFi.status() == WL_CONNECTED) {
-      wifiRSSI = WiFi.RSSI();
-      metrics.wifiReadCount++;
+    // Nível de Sinal WiFi (RSSI suavizado)
+    if (connection.wifiConnected()) {
+      wifiRSSI = rssiFilter.value();
+      validChannels |= 1 << tsdb::CH_RSSI;
     }
     
     unsigned long readTime = micros() - readStartTime;
@@ -475,8 +738,37 @@ void loop() {
       metrics.failedReadings++;
     }
     
+    // Avalia alertas locais e mede o custo
+    float values[tsdb::CHANNEL_COUNT] = {
+      temperature, humidity, lightLevel, soilMoisturePercent, (float)wifiRSSI
+    };
+    unsigned long alertStartTime = micros();
+    alertEngine.evaluate(currentTime, values, validChannels, onAlert, &readStartTime);
+    unsigned long alertEvalTime = micros() - alertStartTime;
+    
+    metrics.alertEvalCount++;
+    metrics.totalAlertEvalTime += alertEvalTime;
+    if (alertEvalTime > metrics.maxAlertEvalTime) metrics.maxAlertEvalTime = alertEvalTime;
+    
+    // Calcula as métricas derivadas e mede o custo contra expf/logf.
+    // O teste não sincroniza o relógio: o DLI usa o dia de uptime.
+    uint32_t agroStart = ESP.getCycleCount();
+    agroMetrics.updateClimate(temperature, humidity);
+    uint32_t referenceStart = ESP.getCycleCount();
+    referenceClimate(temperature, humidity);
+    uint32_t referenceEnd = ESP.getCycleCount();
+    agroMetrics.updateLight(currentTime, currentTime / 86400000UL, lightLevel);
+    
+    uint32_t agroCycles = referenceStart - agroStart;
+    uint32_t referenceCycles = referenceEnd - referenceStart;
+    metrics.agroEvalCount++;
+    metrics.totalAgroCycles += agroCycles;
+    metrics.totalReferenceCycles += referenceCycles;
+    if (agroCycles > metrics.maxAgroCycles) metrics.maxAgroCycles = agroCycles;
+    if (referenceCycles > metrics.maxReferenceCycles) metrics.maxReferenceCycles = referenceCycles;
+    
     // Envia para Blynk e mede latência
-    if (Blynk.connected()) {
+    if (connection.blynkConnected()) {
       unsigned long blynkStartTime = micros();
       
       Blynk.virtualWrite(V0, temperature);
@@ -484,6 +776,9 @@ void loop() {
       Blynk.virtualWrite(V2, lightLevel);
       Blynk.virtualWrite(V3, soilMoisturePercent);
       Blynk.virtualWrite(V4, wifiRSSI);
+      Blynk.virtualWrite(V5, agroMetrics.dewPoint);
+      Blynk.virtualWrite(V6, agroMetrics.vpd);
+      Blynk.virtualWrite(V7, agroMetrics.dli);
       
       unsigned long blynkLatency = micros() - blynkStartTime;
       
@@ -495,6 +790,45 @@ void loop() {
     } else {
       metrics.blynkFailCount++;
     }
+    
+    // Mesmo bloco de log de main.cpp, para o tempo de ciclo medir o custo real
+    LOG_INFO("--- Leituras dos Sensores ---");
+    
+    if (ahtInitialized) {
+      LOG_INFO("🌡️  Temperatura: %.1f °C", temperature);
+      LOG_INFO("💧 Umidade Ar: %.1f %%", humidity);
+      LOG_INFO("🌫️  Ponto de Orvalho: %.1f °C | VPD: %.2f kPa", agroMetrics.dewPoint, agroMetrics.vpd);
+    }
+    
+    if (bh1750Initialized) {
+      LOG_INFO("☀️  Luminosidade: %.0f lux | DLI: %.2f mol/m²/dia", lightLevel, agroMetrics.dli);
+    }
+    
+    LOG_INFO("🌱 Umidade Solo: %.0f %% (ADC: %d)", soilMoisturePercent, soilMoistureRaw);
+    
+    if (connection.wifiConnected()) {
+      const char* quality;
+      if (wifiRSSI > -50) {
+        quality = "Excelente";
+      } else if (wifiRSSI > -60) {
+        quality = "Muito Bom";
+      } else if (wifiRSSI > -70) {
+        quality = "Bom";
+      } else if (wifiRSSI > -80) {
+        quality = "Fraco";
+      } else {
+        quality = "Muito Fraco";
+      }
+      LOG_INFO("📶 Sinal WiFi: %d dBm (%s)", wifiRSSI, quality);
+    } else {
+      LOG_INFO("📶 Sinal WiFi: Desconectado");
+    }
+    
+    unsigned long cycleTime = micros() - readStartTime;
+    metrics.cycleCount++;
+    metrics.totalCycleTime += cycleTime;
+    if (cycleTime < metrics.minCycleTime) metrics.minCycleTime = cycleTime;
+    if (cycleTime > metrics.maxCycleTime) metrics.maxCycleTime = cycleTime;
   }
   
   // Atualiza métricas de memória
@@ -508,6 +842,9 @@ void loop() {
     printMetrics();
   }
   
+  // Envia o log pendente no tempo ocioso (mesma task das métricas, sem intercalar)
+  logger::drain();
+  
   delay(10);
 }
 
@@ -0,0 +1,705 @@
+// Armazenamento de séries temporais em flash (append-only, estilo Gorilla)
+//
+// Guarda o histórico dos canais temperatura, umidade, luminosidade, umidade
+// do solo e RSSI. Cada amostra é codificada com:
+//   - timestamp em delta-of-delta (segundos)
+//   - 1 bit: '0' se nenhum canal mudou, '1' seguido dos valores
+//   - valores float com XOR contra a amostra anterior
+// Antes de codificar, cada valor passa por quantização (absoluta, e relativa
+// para a luminosidade) e por uma banda morta: variações menores que a banda
+// repetem o valor guardado e custam 1 bit. O erro de cada valor lido é
+// limitado por maxError() (ver CHANNEL_CONFIG).
+// Os dados ficam em blocos de 4 KB (um setor de flash) gravados em anel.
+// Um índice em RAM (início/fim de cada bloco) permite pular blocos fora do
+// intervalo consultado.
+//
+// O bloco ativo é montado em RAM e gravado aos poucos no setor já apagado:
+// cada unidade de 4 bytes do payload que fica completa é programada e
+// depois confirmada por um bit num mapa no fim do setor (bits de flash NOR
+// só vão de 1 para 0, então o mapa avança sem novo apagamento). O cabeçalho
+// é gravado por último, quando o bloco enche. Após uma queda de energia,
+// begin() indexa as amostras confirmadas do bloco aberto e a gravação segue
+// no bloco seguinte: perdem-se só as amostras da última unidade (segundos).
+// Exige partição sem criptografia de flash (padrão do core).
+//
+// O código é portátil: compila no ESP32 (partição "tsdb", ver partitions.csv)
+// e no Linux (MemoryStorage, usado em host/tsdb_bench.cpp).
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "channels.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <esp_partition.h>
+#endif
+
+namespace tsdb {
+
+// ======================== CONFIGURAÇÃO ========================
+// Quantização e banda morta de cada canal. Resoluções em potência de 2
+// (1/8 = 0,125) são exatas em float, deixando poucos bits significativos no
+// XOR. A precisão relativa (bits de mantissa) serve à luminosidade, que vai
+// de 0 a dezenas de milhares de lux. Os erros ficam abaixo da exatidão dos
+// sensores (AHT20 ±0,3 °C / ±2 %, BH1750 ±20 %).
+struct ChannelConfig {
+  float resolution;        // Passo absoluto
+  uint8_t mantissaBits;    // Bits de mantissa mantidos (23 = sem limite)
+  float deadband;          // Variação absoluta ignorada
+  float deadbandRelative;  // Variação ignorada, fração do valor guardado
+};
+
+const ChannelConfig CHANNEL_CONFIG[CHANNEL_COUNT] = {
+  {0.125f, 23, 0.125f, 0.0f},   // Temperatura: erro <= 0,19 °C
+  {0.125f, 23, 0.5f,   0.0f},   // Umidade: erro <= 0,57 %
+  {1.0f,   5,  2.0f,   0.05f},  // Luz: erro <= 2,5 lux + 6,6 %
+  {1.0f,   23, 1.0f,   0.0f},   // Solo: erro <= 1,5 %
+  {1.0f,   23, 1.0f,   0.0f},   // RSSI (já suavizado): erro <= 1,5 dBm
+};
+
+const uint32_t BLOCK_SIZE = 4096;          // Um setor de flash
+const uint32_t BLOCK_MAGIC = 0x33425354;   // "TSB3"
+const uint32_t OPEN_MAGIC = 0x4F425354;    // "TSBO": bloco aberto
+const uint32_t MAX_SAMPLE_BYTES = 33;      // Pior caso: 36 + 1 + 5 * 44 bits
+const uint32_t COMMIT_UNIT = 4;            // Bytes de payload por bit de confirmação
+
+// Cabeçalho gravado no início de cada bloco
+struct BlockHeader {
+  uint32_t magic;
+  uint32_t seq;           // Sequência crescente (ordem de gravação)
+  uint32_t startTs;       // Primeiro timestamp (s)
+  uint32_t endTs;         // Último timestamp (s)
+  uint16_t count;         // Número de amostras
+  uint16_t payloadBytes;  // Bytes de dados após o cabeçalho
+};
+
+// Gravado ao apagar o setor (antes da primeira amostra do bloco)
+struct OpenRecord {
+  uint32_t magic;
+  uint32_t seq;
+  uint32_t startTs;
+};
+
+// Setor: cabeçalho | payload | OpenRecord | mapa de confirmação (1 bit por unidade)
+const uint32_t PAYLOAD_SIZE = 3936;
+const uint32_t OPEN_OFFSET = sizeof(BlockHeader) + PAYLOAD_SIZE;
+const uint32_t COMMIT_OFFSET = OPEN_OFFSET + sizeof(OpenRecord);
+const uint32_t COMMIT_BYTES = PAYLOAD_SIZE / COMMIT_UNIT / 8;
+static_assert(COMMIT_OFFSET + COMMIT_BYTES <= BLOCK_SIZE, "bloco maior que o setor");
+
+// Entrada do índice em RAM
+struct BlockIndex {
+  uint32_t seq;
+  uint32_t startTs;
+  uint32_t endTs;
+  uint16_t count;         // 0 = slot vazio
+  uint16_t payloadBytes;  // Limite de leitura na decodificação
+};
+
+// Resultado de uma consulta agregada
+struct Bucket {
+  uint32_t start;  // Início do intervalo (s)
+  uint32_t count;
+  float min;
+  float max;
+  float avg;
+};
+
+// ======================== ARMAZENAMENTO ========================
+class Storage {
+public:
+  virtual ~Storage() {}
+  virtual uint32_t blockCount() const = 0;
+  virtual bool read(uint32_t block, uint32_t offset, void* dst, uint32_t len) = 0;
+  virtual bool erase(uint32_t block) = 0;
+  virtual bool write(uint32_t block, uint32_t offset, const void* src, uint32_t len) = 0;
+};
+
+// Armazenamento em RAM (testes e benchmarks no host). Como na flash NOR, a
+// escrita só zera bits: regravar um byte com 1 onde há 0 não tem efeito.
+class MemoryStorage : public Storage {
+public:
+  MemoryStorage(uint8_t* buffer, uint32_t blocks) : data(buffer), blocks(blocks) {
+    memset(data, 0xFF, blocks * BLOCK_SIZE);
+  }
+  uint32_t blockCount() const { return blocks; }
+  bool read(uint32_t block, uint32_t offset, void* dst, uint32_t len) {
+    if (block >= blocks || offset + len > BLOCK_SIZE) return false;
+    memcpy(dst, data + block * BLOCK_SIZE + offset, len);
+    return true;
+  }
+  bool erase(uint32_t block) {
+    if (block >= blocks) return false;
+    memset(data + block * BLOCK_SIZE, 0xFF, BLOCK_SIZE);
+    return true;
+  }
+  bool write(uint32_t block, uint32_t offset, const void* src, uint32_t len) {
+    if (block >= blocks || offset + len > BLOCK_SIZE) return false;
+    uint8_t* dst = data + block * BLOCK_SIZE + offset;
+    for (uint32_t i = 0; i < len; i++) dst[i] &= ((const uint8_t*)src)[i];
+    return true;
+  }
+private:
+  uint8_t* data;
+  uint32_t blocks;
+};
+
+#if defined(ARDUINO_ARCH_ESP32)
+// Armazenamento na partição de dados "tsdb" (ver partitions.csv)
+class PartitionStorage : public Storage {
+public:
+  bool begin(const char* label = "tsdb") {
+    partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                         ESP_PARTITION_SUBTYPE_ANY, label);
+    return partition != nullptr;
+  }
+  uint32_t blockCount() const {
+    return partition ? partition->size / BLOCK_SIZE : 0;
+  }
+  bool read(uint32_t block, uint32_t offset, void* dst, uint32_t len) {
+    return esp_partition_read(partition, block * BLOCK_SIZE + offset, dst, len) == ESP_OK;
+  }
+  bool erase(uint32_t block) {
+    return esp_partition_erase_range(partition, block * BLOCK_SIZE, BLOCK_SIZE) == ESP_OK;
+  }
+  bool write(uint32_t block, uint32_t offset, const void* src, uint32_t len) {
+    return esp_partition_write(partition, block * BLOCK_SIZE + offset, src, len) == ESP_OK;
+  }
+private:
+  const esp_partition_t* partition = nullptr;
+};
+#endif
+
+// ======================== FLUXO DE BITS ========================
+class BitWriter {
+public:
+  void reset(uint8_t* buffer, uint32_t capacity) {
+    buf = buffer;
+    cap = capacity;
+    bitPos = 0;
+    memset(buf, 0, cap);
+  }
+  // Escreve os n bits menos significativos de value (n <= 32)
+  void write(uint32_t value, uint8_t n) {
+    while (n > 0) {
+      uint8_t free = 8 - (bitPos & 7);
+      uint8_t take = n < free ? n : free;
+      uint8_t bits = (value >> (n - take)) & ((1u << take) - 1);
+      buf[bitPos >> 3] |= bits << (free - take);
+      bitPos += take;
+      n -= take;
+    }
+  }
+  uint32_t bitsUsed() const { return bitPos; }
+  uint32_t bytesUsed() const { return (bitPos + 7) >> 3; }
+  uint32_t bytesFree() const { return cap - bytesUsed(); }
+private:
+  uint8_t* buf = nullptr;
+  uint32_t cap = 0;
+  uint32_t bitPos = 0;
+};
+
+// Leitura limitada a length bytes: além do fim retorna 0 e marca failed()
+class BitReader {
+public:
+  void reset(const uint8_t* buffer, uint32_t length) {
+    buf = buffer;
+    bitPos = 0;
+    limit = length * 8;
+    bad = false;
+  }
+  uint32_t read(uint8_t n) {
+    if (bitPos + n > limit) {
+      bad = true;
+      bitPos = limit;
+      return 0;
+    }
+    uint32_t value = 0;
+    while (n > 0) {
+      uint8_t avail = 8 - (bitPos & 7);
+      uint8_t take = n < avail ? n : avail;
+      uint8_t bits = (buf[bitPos >> 3] >> (avail - take)) & ((1u << take) - 1);
+      value = (value << take) | bits;
+      bitPos += take;
+      n -= take;
+    }
+    return value;
+  }
+  // Fluxo inválido (fim do buffer ou código impossível)
+  void fail() { bad = true; }
+  bool failed() const { return bad; }
+private:
+  const uint8_t* buf = nullptr;
+  uint32_t bitPos = 0;
+  uint32_t limit = 0;
+  bool bad = false;
+};
+
+inline uint32_t floatBits(float v) {
+  uint32_t b;
+  memcpy(&b, &v, sizeof(b));
+  return b;
+}
+
+inline float bitsFloat(uint32_t b) {
+  float v;
+  memcpy(&v, &b, sizeof(v));
+  return v;
+}
+
+inline uint8_t leadingZeros(uint32_t x) {
+  uint8_t n = 0;
+  while (n < 32 && !(x & 0x80000000u)) { x <<= 1; n++; }
+  return n;
+}
+
+inline uint8_t trailingZeros(uint32_t x) {
+  uint8_t n = 0;
+  while (n < 32 && !(x & 1u)) { x >>= 1; n++; }
+  return n;
+}
+
+// ======================== CODEC ========================
+// Estado compartilhado entre codificador e decodificador de um bloco
+struct CodecState {
+  uint32_t prevTs;
+  int32_t prevDelta;
+  uint32_t prevValue[CHANNEL_COUNT];
+  uint8_t prevLeading[CHANNEL_COUNT];
+  uint8_t prevTrailing[CHANNEL_COUNT];
+
+  void reset() {
+    memset(this, 0, sizeof(*this));
+    for (uint8_t c = 0; c < CHANNEL_COUNT; c++) prevLeading[c] = 0xFF;
+  }
+};
+
+// Delta-of-delta: '0' | '10'+7 | '110'+9 | '1110'+12 | '1111'+32 bits
+inline void encodeTimestamp(BitWriter& w, CodecState& s, uint32_t ts) {
+  int32_t delta = (int32_t)(ts - s.prevTs);
+  int32_t dod = delta - s.prevDelta;
+  if (dod == 0) {
+    w.write(0, 1);
+  } else if (dod >= -64 && dod <= 63) {
+    w.write(0x2, 2);
+    w.write((uint32_t)dod & 0x7F, 7);
+  } else if (dod >= -256 && dod <= 255) {
+    w.write(0x6, 3);
+    w.write((uint32_t)dod & 0x1FF, 9);
+  } else if (dod >= -2048 && dod <= 2047) {
+    w.write(0xE, 4);
+    w.write((uint32_t)dod & 0xFFF, 12);
+  } else {
+    w.write(0xF, 4);
+    w.write((uint32_t)dod, 32);
+  }
+  s.prevDelta = delta;
+  s.prevTs = ts;
+}
+
+inline int32_t signExtend(uint32_t v, uint8_t bits) {
+  uint32_t m = 1u << (bits - 1);
+  return (int32_t)((v ^ m) - m);
+}
+
+inline uint32_t decodeTimestamp(BitReader& r, CodecState& s) {
+  int32_t dod;
+  if (r.read(1) == 0) {
+    dod = 0;
+  } else if (r.read(1) == 0) {
+    dod = signExtend(r.read(7), 7);
+  } else if (r.read(1) == 0) {
+    dod = signExtend(r.read(9), 9);
+  } else if (r.read(1) == 0) {
+    dod = signExtend(r.read(12), 12);
+  } else {
+    dod = (int32_t)r.read(32);
+  }
+  s.prevDelta = (int32_t)((uint32_t)s.prevDelta + (uint32_t)dod);  // Sem UB com dados corrompidos
+  s.prevTs += s.prevDelta;
+  return s.prevTs;
+}
+
+// XOR: '0' (igual) | '10' + bits na janela anterior | '11' + 5 + 5 + bits
+inline void encodeValue(BitWriter& w, CodecState& s, uint8_t c, uint32_t bits) {
+  uint32_t x = bits ^ s.prevValue[c];
+  s.prevValue[c] = bits;
+  if (x == 0) {
+    w.write(0, 1);
+    return;
+  }
+  uint8_t leading = leadingZeros(x);
+  uint8_t trailing = trailingZeros(x);
+  if (leading > 31) leading = 31;
+
+  if (s.prevLeading[c] != 0xFF && leading >= s.prevLeading[c] && trailing >= s.prevTrailing[c]) {
+    uint8_t len = 32 - s.prevLeading[c] - s.prevTrailing[c];
+    w.write(0x2, 2);
+    w.write(x >> s.prevTrailing[c], len);
+  } else {
+    uint8_t len = 32 - leading - trailing;
+    w.write(0x3, 2);
+    w.write(leading, 5);
+    w.write(len - 1, 5);
+    w.write(x >> trailing, len);
+    s.prevLeading[c] = leading;
+    s.prevTrailing[c] = trailing;
+  }
+}
+
+inline uint32_t decodeValue(BitReader& r, CodecState& s, uint8_t c) {
+  if (r.read(1) == 0) return s.prevValue[c];
+  if (r.read(1) == 1) {
+    uint8_t leading = r.read(5);
+    uint8_t len = r.read(5) + 1;
+    if (leading + len > 32) {
+      r.fail();
+      return s.prevValue[c];
+    }
+    s.prevLeading[c] = leading;
+    s.prevTrailing[c] = 32 - leading - len;
+  } else if (s.prevLeading[c] == 0xFF) {
+    r.fail();  // Janela anterior inexistente
+    return s.prevValue[c];
+  }
+  uint8_t len = 32 - s.prevLeading[c] - s.prevTrailing[c];
+  s.prevValue[c] ^= r.read(len) << s.prevTrailing[c];
+  return s.prevValue[c];
+}
+
+// Arredonda ao passo absoluto e, se configurado, à precisão relativa
+inline float quantize(uint8_t channel, float value) {
+  const ChannelConfig& cfg = CHANNEL_CONFIG[channel];
+  float q = roundf(value / cfg.resolution) * cfg.resolution;
+  if (cfg.mantissaBits < 23) {
+    uint8_t drop = 23 - cfg.mantissaBits;
+    uint32_t bits = floatBits(q);
+    bits = (bits + (1u << (drop - 1))) & ~((1u << drop) - 1);  // Arredonda a mantissa
+    q = bitsFloat(bits);
+  }
+  return q;
+}
+
+// Aplica a banda morta: mantém held se value estiver dentro dela
+inline float applyDeadband(uint8_t channel, float held, float value) {
+  const ChannelConfig& cfg = CHANNEL_CONFIG[channel];
+  float band = cfg.deadband + cfg.deadbandRelative * fabsf(held);
+  return fabsf(value - held) <= band ? held : value;
+}
+
+// Erro máximo entre o valor lido do histórico e o original
+inline float maxError(uint8_t channel, float value) {
+  const ChannelConfig& cfg = CHANNEL_CONFIG[channel];
+  float a = fabsf(value);
+  float quantization = cfg.resolution * 0.5f;
+  if (cfg.mantissaBits < 23) quantization += a / (float)(1u << (cfg.mantissaBits + 1));
+  // held pode ser maior que value por até a própria banda: |held| <= (a + d) / (1 - r)
+  float held = (a + cfg.deadband + quantization) / (1.0f - cfg.deadbandRelative);
+  return cfg.deadband + cfg.deadbandRelative * held + quantization;
+}
+
+// ======================== STORE ========================
+// Callback de leitura: timestamp e valores de todos os canais
+typedef void (*SampleCallback)(uint32_t ts, const float* values, void* ctx);
+
+class Store {
+public:
+  // Usa até indexSize blocos do armazenamento (uma entrada de índice por bloco)
+  Store(Storage& storage, BlockIndex* index, uint32_t indexSize)
+    : storage(storage), index(index), indexSize(indexSize) {}
+
+  // Reconstrói o índice a partir dos cabeçalhos gravados
+  bool begin() {
+    blocks = storage.blockCount();
+    if (blocks > indexSize) blocks = indexSize;
+    if (blocks < 2) return false;
+
+    uint32_t maxSeq = 0;
+    bool found = false;
+    nextBlock = 0;
+    for (uint32_t b = 0; b < blocks; b++) {
+      BlockHeader h;
+      index[b].count = 0;
+      if (!storage.read(b, 0, &h, sizeof(h))) return false;
+      if (h.magic == BLOCK_MAGIC && h.count > 0 && h.payloadBytes <= PAYLOAD_SIZE) {
+        index[b].seq = h.seq;
+        index[b].startTs = h.startTs;
+        index[b].endTs = h.endTs;
+        index[b].count = h.count;
+        index[b].payloadBytes = h.payloadBytes;
+      } else if (!recover(b)) {
+        continue;
+      }
+      if (!found || index[b].seq > maxSeq) {
+        maxSeq = index[b].seq;
+        nextBlock = (b + 1) % blocks;
+        found = true;
+      }
+    }
+    nextSeq = found ? maxSeq + 1 : 0;
+    lastTs = found ? index[(nextBlock + blocks - 1) % blocks].endTs : 0;
+    openBlock();
+    return true;
+  }
+
+  // Adiciona uma amostra. Timestamps devem ser não-decrescentes (segundos).
+  bool append(uint32_t ts, const float* values) {
+    if (ts < lastTs) return false;
+
+    if (active.count == 0xFFFF || writer.bytesFree() < MAX_SAMPLE_BYTES) {
+      if (!seal()) return false;
+    }
+
+    if (active.count == 0) {
+      active.startTs = ts;
+      if (!startBlock()) return false;
+      state.prevTs = ts;
+    }
+    encodeTimestamp(writer, state, ts);
+    bool changed = false;
+    for (uint8_t c = 0; c < CHANNEL_COUNT; c++) {
+      float q = quantize(c, values[c]);
+      held[c] = hasHeld ? applyDeadband(c, held[c], q) : q;
+      if (floatBits(held[c]) != state.prevValue[c]) changed = true;
+    }
+    hasHeld = true;
+    writer.write(changed ? 1 : 0, 1);
+    if (changed) {
+      for (uint8_t c = 0; c < CHANNEL_COUNT; c++) {
+        encodeValue(writer, state, c, floatBits(held[c]));
+      }
+    }
+    active.count++;
+    active.endTs = ts;
+    lastTs = ts;
+    totalSamples++;
+    return commit(writer.bitsUsed() / (COMMIT_UNIT * 8));
+  }
+
+  // Fecha o bloco ativo mesmo que não esteja cheio. Não é preciso antes de
+  // desligar (as amostras já estão na flash) e desperdiça o resto do setor.
+  bool flush() {
+    return active.count == 0 || seal();
+  }
+
+  // Percorre as amostras em [from, to] em ordem cronológica
+  void scan(uint32_t from, uint32_t to, SampleCallback cb, void* ctx) {
+    // O slot seguinte ao último gravado é o mais antigo do anel
+    for (uint32_t i = 0; i < blocks; i++) {
+      uint32_t b = (nextBlock + i) % blocks;
+      const BlockIndex& e = index[b];
+      if (e.count == 0 || e.endTs < from || e.startTs > to) continue;
+      if (!storage.read(b, sizeof(BlockHeader), scratch, PAYLOAD_SIZE)) continue;
+      decodeBlock(scratch, e.payloadBytes, e.startTs, e.count, from, to, cb, ctx);
+    }
+    if (active.count > 0 && active.endTs >= from && active.startTs <= to) {
+      decodeBlock(activeBuf, writer.bytesUsed(), active.startTs, active.count, from, to, cb, ctx);
+    }
+  }
+
+  // Agrega um canal em intervalos de bucketSeconds a partir de from.
+  // Retorna o número de buckets preenchidos em out (até maxBuckets).
+  uint32_t downsample(uint8_t channel, uint32_t from, uint32_t to, uint32_t bucketSeconds,
+                      Bucket* out, uint32_t maxBuckets) {
+    if (channel >= CHANNEL_COUNT || bucketSeconds == 0 || to < from) return 0;
+    uint32_t n = (to - from) / bucketSeconds + 1;
+    if (n > maxBuckets) n = maxBuckets;
+    for (uint32_t i = 0; i < n; i++) {
+      out[i].start = from + i * bucketSeconds;
+      out[i].count = 0;
+      out[i].min = 0;
+      out[i].max = 0;
+      out[i].avg = 0;
+    }
+
+    AggregateContext agg = {channel, from, bucketSeconds, out, n};
+    scan(from, to, aggregateSample, &agg);
+
+    for (uint32_t i = 0; i < n; i++) {
+      if (out[i].count > 0) out[i].avg /= out[i].count;
+    }
+    return n;
+  }
+
+  uint32_t blockCapacity() const { return blocks; }
+  uint32_t sealedBlocks() const {
+    uint32_t n = 0;
+    for (uint32_t b = 0; b < blocks; b++) if (index[b].count > 0) n++;
+    return n;
+  }
+  uint32_t activeBytes() const { return sizeof(BlockHeader) + writer.bytesUsed(); }
+  uint32_t samplesWritten() const { return totalSamples; }
+
+private:
+  struct AggregateContext {
+    uint8_t channel;
+    uint32_t from;
+    uint32_t bucketSeconds;
+    Bucket* out;
+    uint32_t count;
+  };
+
+  static void aggregateSample(uint32_t ts, const float* values, void* ctx) {
+    AggregateContext* agg = (AggregateContext*)ctx;
+    uint32_t i = (ts - agg->from) / agg->bucketSeconds;
+    if (i >= agg->count) return;
+    Bucket& b = agg->out[i];
+    float v = values[agg->channel];
+    if (b.count == 0 || v < b.min) b.min = v;
+    if (b.count == 0 || v > b.max) b.max = v;
+    b.avg += v;  // Soma; dividida no final
+    b.count++;
+  }
+
+  static uint32_t decodeSample(BitReader& r, CodecState& s, float* values) {
+    uint32_t ts = decodeTimestamp(r, s);
+    bool changed = r.read(1);
+    for (uint8_t c = 0; c < CHANNEL_COUNT; c++) {
+      values[c] = bitsFloat(changed ? decodeValue(r, s, c) : s.prevValue[c]);
+    }
+    return ts;
+  }
+
+  // O primeiro timestamp vem do cabeçalho (delta-of-delta zero no fluxo).
+  // count vem da flash: a leitura para no fim do payload mesmo se estiver
+  // corrompido.
+  void decodeBlock(const uint8_t* payload, uint32_t payloadBytes, uint32_t startTs,
+                   uint16_t count, uint32_t from, uint32_t to, SampleCallback cb, void* ctx) {
+    BitReader r;
+    CodecState s;
+    float values[CHANNEL_COUNT];
+    r.reset(payload, payloadBytes);
+    s.reset();
+    s.prevTs = startTs;
+    for (uint16_t i = 0; i < count; i++) {
+      uint32_t ts = decodeSample(r, s, values);
+      if (r.failed() || ts > to) return;
+      if (ts >= from) cb(ts, values, ctx);
+    }
+  }
+
+  void openBlock() {
+    memset(&active, 0, sizeof(active));
+    active.magic = BLOCK_MAGIC;
+    active.seq = nextSeq;
+    writer.reset(activeBuf, PAYLOAD_SIZE);
+    state.reset();
+  }
+
+  // Bloco aberto sem cabeçalho (queda de energia antes de seal()): indexa
+  // as amostras inteiras nas unidades confirmadas. Só lê a flash; o bloco
+  // não é reaberto.
+  bool recover(uint32_t b) {
+    OpenRecord rec;
+    uint8_t commits[COMMIT_BYTES];
+    if (!storage.read(b, OPEN_OFFSET, &rec, sizeof(rec)) || rec.magic != OPEN_MAGIC ||
+        !storage.read(b, COMMIT_OFFSET, commits, COMMIT_BYTES)) {
+      return false;
+    }
+    uint32_t units = 0;
+    while (units < COMMIT_BYTES * 8 && !(commits[units >> 3] & (0x80 >> (units & 7)))) units++;
+    uint32_t bytes = units * COMMIT_UNIT;
+    if (bytes == 0 || !storage.read(b, sizeof(BlockHeader), scratch, bytes)) return false;
+
+    BitReader r;
+    CodecState s;
+    float values[CHANNEL_COUNT];
+    r.reset(scratch, bytes);
+    s.reset();
+    s.prevTs = rec.startTs;
+    uint16_t count = 0;
+    uint32_t endTs = rec.startTs;
+    while (count < 0xFFFF) {
+      uint32_t ts = decodeSample(r, s, values);
+      if (r.failed()) break;  // Amostra incompleta: resto não confirmado
+      endTs = ts;
+      count++;
+    }
+    if (count == 0) return false;
+    index[b].seq = rec.seq;
+    index[b].startTs = rec.startTs;
+    index[b].endTs = endTs;
+    index[b].count = count;
+    index[b].payloadBytes = bytes;
+    return true;
+  }
+
+  // Apaga o setor do bloco ativo (o mais antigo do anel) e marca-o como aberto
+  bool startBlock() {
+    index[nextBlock].count = 0;
+    committedUnits = 0;
+    OpenRecord rec = {OPEN_MAGIC, active.seq, active.startTs};
+    return storage.erase(nextBlock) && storage.write(nextBlock, OPEN_OFFSET, &rec, sizeof(rec));
+  }
+
+  // Programa as unidades completas do payload até units e depois os bits
+  // que as confirmam (unidade n confirmada = bit n do mapa em 0)
+  bool commit(uint32_t units) {
+    if (units <= committedUnits) return true;
+    uint32_t from = committedUnits * COMMIT_UNIT;
+    if (!storage.write(nextBlock, sizeof(BlockHeader) + from, activeBuf + from,
+                       units * COMMIT_UNIT - from)) {
+      return false;
+    }
+    uint8_t bits[COMMIT_BYTES];
+    uint32_t first = committedUnits >> 3;
+    uint32_t last = (units - 1) >> 3;
+    for (uint32_t i = first; i <= last; i++) {
+      uint32_t n = units - i * 8;
+      bits[i] = n >= 8 ? 0 : (uint8_t)(0xFF >> n);
+    }
+    if (!storage.write(nextBlock, COMMIT_OFFSET + first, bits + first, last - first + 1)) {
+      return false;
+    }
+    committedUnits = units;
+    return true;
+  }
+
+  // Grava o resto do payload e o cabeçalho, com o magic por último
+  bool seal() {
+    active.payloadBytes = writer.bytesUsed();
+    uint32_t from = committedUnits * COMMIT_UNIT;
+    const uint8_t* header = (const uint8_t*)&active;
+    const uint32_t magicSize = sizeof(active.magic);
+    if ((active.payloadBytes > from &&
+         !storage.write(nextBlock, sizeof(BlockHeader) + from, activeBuf + from,
+                        active.payloadBytes - from)) ||
+        !storage.write(nextBlock, magicSize, header + magicSize, sizeof(active) - magicSize) ||
+        !storage.write(nextBlock, 0, header, magicSize)) {
+      return false;
+    }
+
+    index[nextBlock].seq = active.seq;
+    index[nextBlock].startTs = active.startTs;
+    index[nextBlock].endTs = active.endTs;
+    index[nextBlock].count = active.count;
+    index[nextBlock].payloadBytes = active.payloadBytes;
+
+    nextBlock = (nextBlock + 1) % blocks;
+    nextSeq++;
+    openBlock();
+    return true;
+  }
+
+  Storage& storage;
+  BlockIndex* index;
+  uint32_t indexSize;
+  uint32_t blocks = 0;
+  uint32_t nextBlock = 0;
+  uint32_t nextSeq = 0;
+  uint32_t lastTs = 0;
+  uint32_t totalSamples = 0;
+  uint32_t committedUnits = 0;  // Unidades do bloco ativo já confirmadas na flash
+  float held[CHANNEL_COUNT];  // Último valor guardado (referência da banda morta)
+  bool hasHeld = false;
+
+  BlockHeader active;
+  BitWriter writer;
+  CodecState state;
+  uint8_t activeBuf[PAYLOAD_SIZE];
+  uint8_t scratch[PAYLOAD_SIZE];
+};
+
+}  // namespace tsdb
@@ -0,0 +1,193 @@
+// Formato de trace binário das leituras brutas (gravação e reprodução)
+//
+// Arquivo = cabeçalho (16 bytes) + um registro por ciclo de leitura.
+// Todos os campos são little-endian.
+//
+// Cabeçalho:
+//   magic "STRC" | versão u16 | flags u16 | SOIL_DRY i16 | SOIL_WET i16 | intervalo u32 (ms)
+// Registro (16 bytes):
+//   timestamp u32 (ms) | AHT 6 bytes | BH1750 u16 | ADC solo u16 | RSSI i8 | flags u8
+// Com TRACE_HAS_OUTPUTS, cada registro é seguido da saída publicada (21 bytes):
+//   máscara u8 | V0..V4 float
+// permitindo conferir a reprodução bit a bit com o que o dispositivo enviou.
+//
+// Um arquivo por boot (/trace_000.bin, /trace_001.bin, ...): a cada boot o
+// dispositivo começa com um datapath::Pipeline novo (filtro de RSSI sem
+// semente, valores zerados), e o cabeçalho registra a calibração em uso
+// naquele boot. Nunca se acrescenta a um arquivo de outro boot.
+//
+// No ESP32, TraceRecorder grava no LittleFS (partição "spiffs").
+// No Linux, host/trace_replay.cpp reproduz os arquivos pelo mesmo datapath.h,
+// com um Pipeline novo por arquivo.
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "datapath.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <LittleFS.h>
+#endif
+
+namespace trace {
+
+const uint32_t TRACE_MAGIC = 0x43525453;  // "STRC"
+const uint16_t TRACE_VERSION = 1;
+const uint16_t TRACE_HAS_OUTPUTS = 0x0001;
+
+const uint32_t HEADER_SIZE = 16;
+const uint32_t RECORD_SIZE = 16;
+const uint32_t OUTPUT_SIZE = 1 + 4 * datapath::PIN_COUNT;
+const uint16_t MAX_SESSIONS = 1000;  // trace_000.bin .. trace_999.bin
+
+struct Header {
+  uint16_t version;
+  uint16_t flags;
+  int16_t soilDry;
+  int16_t soilWet;
+  uint32_t intervalMs;
+};
+
+// ======================== CODIFICAÇÃO ========================
+inline void put16(uint8_t* p, uint16_t v) {
+  p[0] = v;
+  p[1] = v >> 8;
+}
+
+inline void put32(uint8_t* p, uint32_t v) {
+  p[0] = v;
+  p[1] = v >> 8;
+  p[2] = v >> 16;
+  p[3] = v >> 24;
+}
+
+inline uint16_t get16(const uint8_t* p) {
+  return p[0] | ((uint16_t)p[1] << 8);
+}
+
+inline uint32_t get32(const uint8_t* p) {
+  return p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+inline void encodeHeader(const Header& h, uint8_t* p) {
+  put32(p, TRACE_MAGIC);
+  put16(p + 4, h.version);
+  put16(p + 6, h.flags);
+  put16(p + 8, (uint16_t)h.soilDry);
+  put16(p + 10, (uint16_t)h.soilWet);
+  put32(p + 12, h.intervalMs);
+}
+
+inline bool decodeHeader(const uint8_t* p, Header& h) {
+  if (get32(p) != TRACE_MAGIC) return false;
+  h.version = get16(p + 4);
+  h.flags = get16(p + 6);
+  h.soilDry = (int16_t)get16(p + 8);
+  h.soilWet = (int16_t)get16(p + 10);
+  h.intervalMs = get32(p + 12);
+  return h.version == TRACE_VERSION;
+}
+
+inline void encodeRecord(const datapath::RawSample& s, uint8_t* p) {
+  put32(p, s.timestampMs);
+  memcpy(p + 4, s.aht, 6);
+  put16(p + 10, s.bh1750);
+  put16(p + 12, s.soilAdc);
+  p[14] = (uint8_t)s.rssi;
+  p[15] = s.flags;
+}
+
+inline void decodeRecord(const uint8_t* p, datapath::RawSample& s) {
+  s.timestampMs = get32(p);
+  memcpy(s.aht, p + 4, 6);
+  s.bh1750 = get16(p + 10);
+  s.soilAdc = get16(p + 12);
+  s.rssi = (int8_t)p[14];
+  s.flags = p[15];
+}
+
+inline void encodeOutput(const datapath::Published& o, uint8_t* p) {
+  p[0] = o.mask;
+  for (uint8_t i = 0; i < datapath::PIN_COUNT; i++) {
+    uint32_t bits;
+    memcpy(&bits, &o.values[i], sizeof(bits));
+    put32(p + 1 + 4 * i, bits);
+  }
+}
+
+inline void decodeOutput(const uint8_t* p, datapath::Published& o) {
+  o.mask = p[0];
+  for (uint8_t i = 0; i < datapath::PIN_COUNT; i++) {
+    uint32_t bits = get32(p + 1 + 4 * i);
+    memcpy(&o.values[i], &bits, sizeof(bits));
+  }
+}
+
+#if defined(ARDUINO_ARCH_ESP32)
+// ======================== GRAVAÇÃO (ESP32) ========================
+// Acumula registros em RAM e grava em blocos de 512 bytes no LittleFS.
+// Cria o primeiro arquivo livre da sequência (um por boot) e para de gravar
+// quando o sistema de arquivos está quase cheio.
+class TraceRecorder {
+public:
+  bool begin(const Header& h, const char* prefix = "/trace_") {
+    if (!LittleFS.begin(true)) return false;
+    uint16_t session = 0;
+    for (; session < MAX_SESSIONS; session++) {
+      snprintf(filePath, sizeof(filePath), "%s%03u.bin", prefix, session);
+      if (!LittleFS.exists(filePath)) break;
+    }
+    if (session == MAX_SESSIONS) return false;
+    file = LittleFS.open(filePath, "w");
+    if (!file) return false;
+    hasOutputs = h.flags & TRACE_HAS_OUTPUTS;
+    uint8_t header[HEADER_SIZE];
+    encodeHeader(h, header);
+    file.write(header, HEADER_SIZE);
+    active = true;
+    return true;
+  }
+
+  void record(const datapath::RawSample& s, const datapath::Published& o) {
+    if (!active) return;
+    encodeRecord(s, buffer + used);
+    used += RECORD_SIZE;
+    if (hasOutputs) {
+      encodeOutput(o, buffer + used);
+      used += OUTPUT_SIZE;
+    }
+    recordCount++;
+    if (used + RECORD_SIZE + OUTPUT_SIZE > sizeof(buffer)) flush();
+  }
+
+  void flush() {
+    if (!active || used == 0) return;
+    // Mantém uma margem para o LittleFS
+    if (LittleFS.totalBytes() - LittleFS.usedBytes() < 4 * sizeof(buffer)) {
+      file.close();
+      active = false;
+      return;
+    }
+    file.write(buffer, used);
+    file.flush();
+    used = 0;
+  }
+
+  bool recording() const { return active; }
+  uint32_t records() const { return recordCount; }
+  const char* path() const { return filePath; }
+
+private:
+  File file;
+  char filePath[32] = "";
+  uint8_t buffer[512];
+  uint32_t used = 0;
+  uint32_t recordCount = 0;
+  bool hasOutputs = false;
+  bool active = false;
+};
+#endif
+
+}  // namespace trace